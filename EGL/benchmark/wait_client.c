@@ -0,0 +1,152 @@
+/**
+ * Compares the latency of eglWaitClient against glFinish.
+ *
+ * Both paths wait for the same amount of queued rendering into a pbuffer. Build with -DEGL_BUILD_BENCHMARK=ON and run
+ * the executable on a machine with a GL driver. The optional argument is the number of iterations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <EGL/egl.h>
+
+#define GL_COLOR_BUFFER_BIT 0x00004000
+
+typedef void (*PFN_glClearColor)(float red, float green, float blue, float alpha);
+typedef void (*PFN_glClear)(unsigned int mask);
+typedef void (*PFN_glFinish)(void);
+
+#define CLEARS_PER_ITERATION 64
+
+static PFN_glClearColor glClearColor_PTR;
+static PFN_glClear glClear_PTR;
+static PFN_glFinish glFinish_PTR;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	timespec_get(&ts, TIME_UTC);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void queueWork(int iteration)
+{
+	for (int i = 0; i < CLEARS_PER_ITERATION; i++)
+	{
+		glClearColor_PTR((float)(i & 1), (float)(iteration & 1), 0.0f, 1.0f);
+		glClear_PTR(GL_COLOR_BUFFER_BIT);
+	}
+}
+
+static double measure(int iterations, int useWaitClient)
+{
+	double total = 0.0;
+
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		queueWork(iteration);
+
+		double start = now();
+
+		if (useWaitClient)
+		{
+			eglWaitClient();
+		}
+		else
+		{
+			glFinish_PTR();
+		}
+
+		total += now() - start;
+	}
+
+	return total / (double)iterations;
+}
+
+int main(int argc, char* argv[])
+{
+	int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+
+	if (iterations < 1)
+	{
+		iterations = 1;
+	}
+
+	EGLDisplay dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, NULL, NULL))
+	{
+		fprintf(stderr, "Could not initialize EGL: 0x%04x\n", eglGetError());
+
+		return 1;
+	}
+
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint numConfigs = 0;
+
+	if (!eglChooseConfig(dpy, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+	{
+		fprintf(stderr, "No pbuffer configuration: 0x%04x\n", eglGetError());
+
+		return 1;
+	}
+
+	const EGLint surfaceAttribs[] = {
+		EGL_WIDTH, 1024,
+		EGL_HEIGHT, 1024,
+		EGL_NONE
+	};
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	EGLSurface surface = eglCreatePbufferSurface(dpy, config, surfaceAttribs);
+	EGLContext ctx = eglCreateContext(dpy, config, EGL_NO_CONTEXT, NULL);
+
+	if (surface == EGL_NO_SURFACE || ctx == EGL_NO_CONTEXT || !eglMakeCurrent(dpy, surface, surface, ctx))
+	{
+		fprintf(stderr, "Could not create the context: 0x%04x\n", eglGetError());
+
+		return 1;
+	}
+
+	glClearColor_PTR = (PFN_glClearColor)eglGetProcAddress("glClearColor");
+	glClear_PTR = (PFN_glClear)eglGetProcAddress("glClear");
+	glFinish_PTR = (PFN_glFinish)eglGetProcAddress("glFinish");
+
+	if (!glClearColor_PTR || !glClear_PTR || !glFinish_PTR)
+	{
+		fprintf(stderr, "Could not resolve the GL functions\n");
+
+		return 1;
+	}
+
+	// Warm up, so both paths start with a loaded driver.
+	measure(16, 0);
+	measure(16, 1);
+
+	double finishLatency = measure(iterations, 0);
+	double waitClientLatency = measure(iterations, 1);
+
+	printf("iterations:    %d\n", iterations);
+	printf("glFinish:      %.3f us\n", finishLatency * 1e6);
+	printf("eglWaitClient: %.3f us\n", waitClientLatency * 1e6);
+
+	eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(dpy, ctx);
+	eglDestroySurface(dpy, surface);
+	eglTerminate(dpy);
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef EGL_DIAGNOSTICS_H_
+#define EGL_DIAGNOSTICS_H_
+
+#include <EGL/egl.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Diagnostic counters of this implementation. Not part of any EGL specification.
+ * The values are cumulative for the lifetime of the display.
+ */
+
+/* eglChooseConfig calls answered from the per display cache. */
+#define EGL_DIAGNOSTIC_CHOOSE_CONFIG_CACHE_HITS 0x0001
+/* eglChooseConfig calls, which had to filter and sort the configurations. */
+#define EGL_DIAGNOSTIC_CHOOSE_CONFIG_CACHE_MISSES 0x0002
+/* eglMakeCurrent calls, which returned early, as the binding was already current to the calling thread. */
+#define EGL_DIAGNOSTIC_MAKE_CURRENT_ELIDED 0x0003
+
+EGLAPI EGLBoolean EGLAPIENTRY eglQueryDisplayDiagnostic (EGLDisplay dpy, EGLint name, EGLAttrib *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
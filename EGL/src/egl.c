@@ -24,7 +24,12 @@
  * THE SOFTWARE.
  */
 
+#include <string.h>
+
+#define EGL_EGLEXT_PROTOTYPES
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <EGL/egldiagnostics.h>
 
 //
 // Native external implementations.
@@ -108,6 +113,40 @@ EGLContext _eglGetCurrentContext (void);
 // EGL_VERSION_1_5
 //
 
+extern EGLSync _eglCreateSync (EGLDisplay dpy, EGLenum type, const EGLAttrib *attrib_list);
+
+extern EGLBoolean _eglDestroySync (EGLDisplay dpy, EGLSync sync);
+
+extern EGLint _eglClientWaitSync (EGLDisplay dpy, EGLSync sync, EGLint flags, EGLTime timeout);
+
+extern EGLBoolean _eglGetSyncAttrib (EGLDisplay dpy, EGLSync sync, EGLint attribute, EGLAttrib *value);
+
+extern EGLBoolean _eglWaitSync (EGLDisplay dpy, EGLSync sync, EGLint flags);
+
+extern EGLImage _eglCreateImage (EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLAttrib *attrib_list);
+
+extern EGLBoolean _eglDestroyImage (EGLDisplay dpy, EGLImage image);
+
+//
+// Extensions
+//
+
+extern EGLSyncKHR _eglCreateSyncKHR (EGLDisplay dpy, EGLenum type, const EGLint *attrib_list);
+
+extern EGLBoolean _eglSignalSyncKHR (EGLDisplay dpy, EGLSyncKHR sync, EGLenum mode);
+
+extern EGLImageKHR _eglCreateImageKHR (EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list);
+
+extern void _eglImageTargetTexture2D (unsigned int target, void *image);
+
+extern void _eglImageTargetRenderbufferStorage (unsigned int target, void *image);
+
+//
+// Diagnostics
+//
+
+extern EGLBoolean _eglQueryDisplayDiagnostic (EGLDisplay dpy, EGLint name, EGLAttrib *value);
+
 //
 // Wrapper.
 //
@@ -190,8 +229,43 @@ EGLAPI EGLint EGLAPIENTRY eglGetError (void)
 	return _eglGetError();
 }
 
+static void EGLAPIENTRY glEGLImageTargetTexture2DOES (unsigned int target, void *image);
+
+static void EGLAPIENTRY glEGLImageTargetRenderbufferStorageOES (unsigned int target, void *image);
+
+// Extension functions of EGL itself. Everything else is resolved by the native GL.
+static const struct
+{
+	const char *name;
+	__eglMustCastToProperFunctionPointerType proc;
+} g_extensionProcs[] = {
+	{ "eglCreateSyncKHR", (__eglMustCastToProperFunctionPointerType)eglCreateSyncKHR },
+	{ "eglDestroySyncKHR", (__eglMustCastToProperFunctionPointerType)eglDestroySyncKHR },
+	{ "eglClientWaitSyncKHR", (__eglMustCastToProperFunctionPointerType)eglClientWaitSyncKHR },
+	{ "eglSignalSyncKHR", (__eglMustCastToProperFunctionPointerType)eglSignalSyncKHR },
+	{ "eglGetSyncAttribKHR", (__eglMustCastToProperFunctionPointerType)eglGetSyncAttribKHR },
+	{ "eglWaitSyncKHR", (__eglMustCastToProperFunctionPointerType)eglWaitSyncKHR },
+	{ "eglCreateImageKHR", (__eglMustCastToProperFunctionPointerType)eglCreateImageKHR },
+	{ "eglDestroyImageKHR", (__eglMustCastToProperFunctionPointerType)eglDestroyImageKHR },
+	{ "glEGLImageTargetTexture2DOES", (__eglMustCastToProperFunctionPointerType)glEGLImageTargetTexture2DOES },
+	{ "glEGLImageTargetRenderbufferStorageOES", (__eglMustCastToProperFunctionPointerType)glEGLImageTargetRenderbufferStorageOES },
+};
+
 EGLAPI __eglMustCastToProperFunctionPointerType EGLAPIENTRY eglGetProcAddress (const char *procname)
 {
+	size_t i;
+
+	if (procname)
+	{
+		for (i = 0; i < sizeof(g_extensionProcs) / sizeof(g_extensionProcs[0]); i++)
+		{
+			if (strcmp(g_extensionProcs[i].name, procname) == 0)
+			{
+				return g_extensionProcs[i].proc;
+			}
+		}
+	}
+
 	return _eglGetProcAddress (procname);
 }
 
@@ -232,17 +306,8 @@ EGLAPI EGLBoolean EGLAPIENTRY eglTerminate (EGLDisplay dpy)
 
 EGLAPI EGLBoolean EGLAPIENTRY eglWaitGL (void)
 {
-	EGLBoolean result;
-
-    EGLenum api = _eglQueryAPI();
-
-    _eglBindAPI(EGL_OPENGL_ES_API);
-
-    result = _eglWaitClient();
-
-    _eglBindAPI(api);
-
-    return result;
+	// Same as eglWaitClient, as there are only OpenGL contexts.
+	return _eglWaitClient();
 }
 
 EGLAPI EGLBoolean EGLAPIENTRY eglWaitNative (EGLint engine)
@@ -332,44 +397,32 @@ EGLAPI EGLContext EGLAPIENTRY eglGetCurrentContext (void)
 
 EGLAPI EGLSync EGLAPIENTRY eglCreateSync (EGLDisplay dpy, EGLenum type, const EGLAttrib *attrib_list)
 {
-	// TODO Implement.
-
-	return EGL_NO_SYNC;
+	return _eglCreateSync (dpy, type, attrib_list);
 }
 
 EGLAPI EGLBoolean EGLAPIENTRY eglDestroySync (EGLDisplay dpy, EGLSync sync)
 {
-	// TODO Implement.
-
-	return EGL_FALSE;
+	return _eglDestroySync (dpy, sync);
 }
 
 EGLAPI EGLint EGLAPIENTRY eglClientWaitSync (EGLDisplay dpy, EGLSync sync, EGLint flags, EGLTime timeout)
 {
-	// TODO Implement.
-
-	return EGL_FALSE;
+	return _eglClientWaitSync (dpy, sync, flags, timeout);
 }
 
 EGLAPI EGLBoolean EGLAPIENTRY eglGetSyncAttrib (EGLDisplay dpy, EGLSync sync, EGLint attribute, EGLAttrib *value)
 {
-	// TODO Implement.
-
-	return EGL_FALSE;
+	return _eglGetSyncAttrib (dpy, sync, attribute, value);
 }
 
-EGLAPI EGLImage EGLAPIENTRY eglCreateImage (EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list)
+EGLAPI EGLImage EGLAPIENTRY eglCreateImage (EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLAttrib *attrib_list)
 {
-	// TODO Implement.
-
-	return EGL_NO_IMAGE;
+	return _eglCreateImage (dpy, ctx, target, buffer, attrib_list);
 }
 
 EGLAPI EGLBoolean EGLAPIENTRY eglDestroyImage (EGLDisplay dpy, EGLImage image)
 {
-	// TODO Implement.
-
-	return EGL_FALSE;
+	return _eglDestroyImage (dpy, image);
 }
 
 EGLAPI EGLDisplay EGLAPIENTRY eglGetPlatformDisplay (EGLenum platform, void *native_display, const EGLAttrib *attrib_list)
@@ -395,9 +448,80 @@ EGLAPI EGLSurface EGLAPIENTRY eglCreatePlatformPixmapSurface (EGLDisplay dpy, EG
 
 EGLAPI EGLBoolean EGLAPIENTRY eglWaitSync (EGLDisplay dpy, EGLSync sync, EGLint flags)
 {
-	// TODO Implement.
+	return _eglWaitSync (dpy, sync, flags);
+}
 
-	return EGL_FALSE;
+//
+// Extensions
+//
+
+EGLAPI EGLSyncKHR EGLAPIENTRY eglCreateSyncKHR (EGLDisplay dpy, EGLenum type, const EGLint *attrib_list)
+{
+	return _eglCreateSyncKHR (dpy, type, attrib_list);
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglDestroySyncKHR (EGLDisplay dpy, EGLSyncKHR sync)
+{
+	return _eglDestroySync (dpy, sync);
+}
+
+EGLAPI EGLint EGLAPIENTRY eglClientWaitSyncKHR (EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout)
+{
+	return _eglClientWaitSync (dpy, sync, flags, timeout);
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglSignalSyncKHR (EGLDisplay dpy, EGLSyncKHR sync, EGLenum mode)
+{
+	return _eglSignalSyncKHR (dpy, sync, mode);
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglGetSyncAttribKHR (EGLDisplay dpy, EGLSyncKHR sync, EGLint attribute, EGLint *value)
+{
+	EGLAttrib attribValue;
+
+	if (!_eglGetSyncAttrib (dpy, sync, attribute, value ? &attribValue : 0))
+	{
+		return EGL_FALSE;
+	}
+
+	*value = (EGLint)attribValue;
+
+	return EGL_TRUE;
+}
+
+EGLAPI EGLint EGLAPIENTRY eglWaitSyncKHR (EGLDisplay dpy, EGLSyncKHR sync, EGLint flags)
+{
+	return _eglWaitSync (dpy, sync, flags);
+}
+
+EGLAPI EGLImageKHR EGLAPIENTRY eglCreateImageKHR (EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint *attrib_list)
+{
+	return _eglCreateImageKHR (dpy, ctx, target, buffer, attrib_list);
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglDestroyImageKHR (EGLDisplay dpy, EGLImageKHR image)
+{
+	return _eglDestroyImage (dpy, image);
+}
+
+// GL_OES_EGL_image, only reachable through eglGetProcAddress.
+static void EGLAPIENTRY glEGLImageTargetTexture2DOES (unsigned int target, void *image)
+{
+	_eglImageTargetTexture2D (target, image);
+}
+
+static void EGLAPIENTRY glEGLImageTargetRenderbufferStorageOES (unsigned int target, void *image)
+{
+	_eglImageTargetRenderbufferStorage (target, image);
+}
+
+//
+// Diagnostics
+//
+
+EGLAPI EGLBoolean EGLAPIENTRY eglQueryDisplayDiagnostic (EGLDisplay dpy, EGLint name, EGLAttrib *value)
+{
+	return _eglQueryDisplayDiagnostic (dpy, name, value);
 }
 
 /*
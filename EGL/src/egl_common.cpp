@@ -24,46 +24,110 @@
  * THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <climits>
 #include <thread>
 #include "egl_internal.h"
+#include <EGL/eglext.h>
+#include <EGL/egldiagnostics.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EGL_CONFIG_FILTER_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define EGL_CONFIG_FILTER_AVX2
+#include <immintrin.h>
+#endif
+#endif
 
 #define EGL_NO_SURFACE_IMPL static_cast<EGLSurfaceImpl*>(EGL_NO_SURFACE)
 #define EGL_NO_CONTEXT_IMPL static_cast<EGLContextImpl*>(EGL_NO_CONTEXT)
 
+// Reader of the display list. Each thread owns one record and is the only one writing it.
+struct alignas(64) EGLReaderRecord
+{
+	// Epoch, in which the outermost read section was entered. Zero, if not reading.
+	std::atomic<uint64_t> epoch{ 0 };
+	std::atomic<bool> inUse{ false };
+
+	uint32_t depth = 0;
+
+	EGLReaderRecord* next = nullptr;
+};
+
+//
+// The display list is read without locks: Readers only announce the current epoch in their own record. Writers are
+// serialized, publish with atomic stores and wait until every reader of an older epoch has left, before a display
+// unlinked from the list is deleted.
+//
 struct GlobalStorage
 {
-	EGLDisplayImpl* rootDpy = nullptr;
+	std::atomic<EGLDisplayImpl*> rootDpy{ nullptr };
+
+	// Retired objects and terminated displays of all displays, which still have to be reclaimed.
+	std::atomic<EGLint> retiredCount{ 0 };
 
 	void rootDpy_readacq()
 	{
-		lock_read(lock_dpy);
+		EGLReaderRecord* record = localReader();
+
+		if (record->depth++ == 0)
+		{
+			record->epoch.store(epoch.load());
+		}
 	}
 	void rootDpy_writeacq()
 	{
-		lock_write(lock_dpy);
+		writerMutex.lock();
 	}
 	void rootDpy_readrel()
 	{
-		unlock_read(lock_dpy);
+		EGLReaderRecord* record = localReader();
+
+		if (--record->depth == 0)
+		{
+			record->epoch.store(0, std::memory_order_release);
+		}
 	}
 	void rootDpy_writerel()
 	{
-		unlock_write(lock_dpy);
+		writerMutex.unlock();
+	}
+
+	// Waits, until no reader can still reference a display unlinked before this call. Must not be called inside a read
+	// section or with the write lock held.
+	void rootDpy_synchronize()
+	{
+		const uint64_t target = ++epoch;
+
+		for (EGLReaderRecord* record = readers.load(); record; record = record->next)
+		{
+			uint64_t readerEpoch;
+			while ((readerEpoch = record->epoch.load()) != 0 && readerEpoch < target)
+			{
+				std::this_thread::yield();
+			}
+		}
 	}
 
 	auto dummy_read()
 	{
-		lock_read(lock_dummy);
-		auto d = dummy;
-		unlock_read(lock_dummy);
-		return d;
+		std::lock_guard<std::mutex> _{ dummyMutex };
+		return dummy;
 	}
 	void dummy_write(NativeLocalStorageContainer d)
 	{
-		lock_write(lock_dummy);
+		std::lock_guard<std::mutex> _{ dummyMutex };
 		dummy = d;
-		unlock_write(lock_dummy);
 	}
 
 	struct ReadLock
@@ -103,1060 +167,2878 @@ struct GlobalStorage
 
 private:
 	NativeLocalStorageContainer dummy;
+	std::mutex dummyMutex;
+
+	std::mutex writerMutex;
 
-	std::atomic_uint32_t lock_dpy = 0u;
-	std::atomic_uint32_t lock_dummy = 0u;
+	std::atomic<uint64_t> epoch{ 1 };
+	// Records are reused by later threads, but never freed.
+	std::atomic<EGLReaderRecord*> readers{ nullptr };
 
-	static void lock_read(std::atomic_uint32_t& c) 
+	struct ReaderSlot
 	{
-		if (++c > LOCK_WRITE_VALUE)
+		ReaderSlot(GlobalStorage* gs)
 		{
-			while (c >= LOCK_WRITE_VALUE)
-				std::this_thread::yield();
+			for (record = gs->readers.load(); record; record = record->next)
+			{
+				bool expected = false;
+				if (record->inUse.compare_exchange_strong(expected, true))
+				{
+					return;
+				}
+			}
+
+			record = new EGLReaderRecord();
+			record->inUse = true;
+			record->next = gs->readers.load();
+			while (!gs->readers.compare_exchange_weak(record->next, record))
+			{
+			}
 		}
-	}
-	static void unlock_read(std::atomic_uint32_t& c)
-	{
-		--c;
-	}
-	static void lock_write(std::atomic_uint32_t& c)
-	{
-		uint32_t expected = 0u;
-		while (!c.compare_exchange_strong(expected, LOCK_WRITE_VALUE))
+		~ReaderSlot()
 		{
-			expected = 0u;
-			std::this_thread::yield();
+			record->inUse = false;
 		}
-	}
-	static void unlock_write(std::atomic_uint32_t& c)
+
+		EGLReaderRecord* record;
+	};
+
+	EGLReaderRecord* localReader()
 	{
-		c -= LOCK_WRITE_VALUE;
-	}
+		static thread_local ReaderSlot slot(this);
 
-	constexpr inline static uint32_t LOCK_WRITE_VALUE = 0xdeadbeefu;
+		return slot.record;
+	}
 };
 
 typedef std::lock_guard<std::mutex> guard_t;
 
 static thread_local LocalStorage g_localStorage =
-    { EGL_SUCCESS, EGL_NONE, EGL_NO_CONTEXT_IMPL };
+    { EGL_SUCCESS, EGL_NONE, EGL_NO_CONTEXT_IMPL, 0, EGL_NO_SURFACE_IMPL, EGL_NO_SURFACE_IMPL };
 
 static GlobalStorage g_globalStorage;
 
-static EGLint g_GL_max_supported_version[2] = { 0, 0 };
-static EGLint g_ES_max_supported_version[2] = { 0, 0 };
+// Context versions, which are probed when the requested one does not exist.
+static const EGLint g_GL_versions[][2] = {
+	{ 1, 0 }, { 1, 1 }, { 1, 2 }, { 1, 3 }, { 1, 4 }, { 1, 5 },
+	{ 2, 0 }, { 2, 1 },
+	{ 3, 0 }, { 3, 1 }, { 3, 2 }, { 3, 3 },
+	{ 4, 0 }, { 4, 1 }, { 4, 2 }, { 4, 3 }, { 4, 4 }, { 4, 5 }, { 4, 6 }
+};
+static const EGLint g_ES_versions[][2] = {
+	{ 1, 0 }, { 1, 1 },
+	{ 2, 0 },
+	{ 3, 0 }, { 3, 1 }, { 3, 2 }
+};
+
+// Extensions listed in EGL_EXTENSIONS, sorted by name. Native ones depend on the platform of the display. Support of
+// some is also kept on the display, as they change which attributes are accepted.
+static const struct
+{
+	const char* name;
+	EGLBoolean native;
+	EGLBoolean EGLDisplayImpl::* supported;
+} g_extensions[] = {
+	{ "EGL_KHR_context_flush_control", EGL_TRUE, &EGLDisplayImpl::contextFlushControl },
+	{ "EGL_KHR_create_context_no_error", EGL_TRUE, &EGLDisplayImpl::contextNoError },
+	{ "EGL_KHR_fence_sync", EGL_FALSE, 0 },
+	{ "EGL_KHR_gl_renderbuffer_image", EGL_FALSE, 0 },
+	{ "EGL_KHR_gl_texture_2D_image", EGL_FALSE, 0 },
+	{ "EGL_KHR_image_base", EGL_FALSE, 0 },
+	{ "EGL_KHR_no_config_context", EGL_FALSE, 0 },
+	{ "EGL_KHR_reusable_sync", EGL_FALSE, 0 },
+	{ "EGL_KHR_surfaceless_context", EGL_TRUE, 0 },
+	{ "EGL_KHR_wait_sync", EGL_FALSE, 0 }
+};
 
 #if defined(EGL_NO_GLEW)
 extern void (*glFinish_PTR)();
 #define glFinish(...) glFinish_PTR(__VA_ARGS__)
 #endif
 
-extern "C" 
-{
+// GL_ARB_sync, resolved on first use, as not every GL header declares it.
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_STATUS 0x9114
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SIGNALED 0x9119
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+#endif
 
-static EGLBoolean _eglInternalInit()
+typedef void* (APIENTRY *__PFN_glFenceSync)(GLenum condition, GLbitfield flags);
+typedef void (APIENTRY *__PFN_glDeleteSync)(void* sync);
+typedef GLenum (APIENTRY *__PFN_glClientWaitSync)(void* sync, GLbitfield flags, uint64_t timeout);
+typedef void (APIENTRY *__PFN_glGetSynciv)(void* sync, GLenum pname, GLsizei bufSize, GLsizei* length, GLint* values);
+typedef void (APIENTRY *__PFN_glWaitSync)(void* sync, GLbitfield flags, uint64_t timeout);
+typedef void (APIENTRY *__PFN_glFlush)();
+
+struct GLSyncFunctions
 {
-	auto dummy = g_globalStorage.dummy_read();
-	EGLBoolean r = __internalInit(&dummy, g_GL_max_supported_version, g_ES_max_supported_version);
-	g_globalStorage.dummy_write(dummy);
+	__PFN_glFenceSync fenceSync;
+	__PFN_glDeleteSync deleteSync;
+	__PFN_glClientWaitSync clientWaitSync;
+	__PFN_glGetSynciv getSynciv;
+	__PFN_glWaitSync waitSync;
+	__PFN_glFlush flush;
+};
 
-	return r;
-}
+// GL_ARB_framebuffer_object and OpenGL 1.2, as old GL headers lack them.
+#ifndef GL_RENDERBUFFER
+#define GL_RENDERBUFFER 0x8D41
+#define GL_RENDERBUFFER_BINDING 0x8CA7
+#define GL_RENDERBUFFER_WIDTH 0x8D42
+#define GL_RENDERBUFFER_HEIGHT 0x8D43
+#define GL_RENDERBUFFER_SAMPLES 0x8CAB
+#endif
+#ifndef GL_TEXTURE_BASE_LEVEL
+#define GL_TEXTURE_BASE_LEVEL 0x813C
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
 
-static void _eglInternalTerminate()
+typedef GLboolean (APIENTRY *__PFN_glIsTexture)(GLuint texture);
+typedef GLboolean (APIENTRY *__PFN_glIsRenderbuffer)(GLuint renderbuffer);
+typedef void (APIENTRY *__PFN_glBindTexture)(GLenum target, GLuint texture);
+typedef void (APIENTRY *__PFN_glBindRenderbuffer)(GLenum target, GLuint renderbuffer);
+typedef void (APIENTRY *__PFN_glGetIntegerv)(GLenum pname, GLint* data);
+typedef void (APIENTRY *__PFN_glGetTexParameteriv)(GLenum target, GLenum pname, GLint* params);
+typedef void (APIENTRY *__PFN_glGetTexLevelParameteriv)(GLenum target, GLint level, GLenum pname, GLint* params);
+typedef void (APIENTRY *__PFN_glGetRenderbufferParameteriv)(GLenum target, GLenum pname, GLint* params);
+
+struct GLImageFunctions
 {
-	auto dummy = g_globalStorage.dummy_read();
-	__internalTerminate(&dummy);
-	g_globalStorage.dummy_write(dummy);
-}
+	__PFN_glIsTexture isTexture;
+	__PFN_glIsRenderbuffer isRenderbuffer;
+	__PFN_glBindTexture bindTexture;
+	__PFN_glBindRenderbuffer bindRenderbuffer;
+	__PFN_glGetIntegerv getIntegerv;
+	__PFN_glGetTexParameteriv getTexParameteriv;
+	__PFN_glGetTexLevelParameteriv getTexLevelParameteriv;
+	__PFN_glGetRenderbufferParameteriv getRenderbufferParameteriv;
+};
 
-static void _eglInternalCleanup()
+// The live objects of a display are doubly linked, so a destroyed object is unlinked without walking the list.
+template<typename T>
+static void _eglInternalLink(T** root, T* object)
 {
-	EGLDisplayImpl* tempDpy = 0;
+	object->prev = 0;
+	object->next = *root;
 
+	if (*root)
 	{
-		auto _wl = g_globalStorage.placeRootDpy_writelock();
-		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
-
-		while (walkerDpy)
-		{
-			EGLSurfaceImpl* tempSurface = 0;
+		(*root)->prev = object;
+	}
 
-			EGLSurfaceImpl* walkerSurface = walkerDpy->rootSurface;
+	*root = object;
+}
 
-			EGLContextImpl* tempCtx = 0;
+template<typename T>
+static void _eglInternalUnlink(T** root, T* object)
+{
+	if (object->prev)
+	{
+		object->prev->next = object->next;
+	}
+	else
+	{
+		*root = object->next;
+	}
 
-			EGLContextImpl* walkerCtx = walkerDpy->rootCtx;
+	if (object->next)
+	{
+		object->next->prev = object->prev;
+	}
 
-			while (walkerSurface)
-			{
-				if (walkerSurface->destroy && walkerSurface != walkerDpy->currentDraw && walkerSurface != walkerDpy->currentRead)
-				{
-					EGLSurfaceImpl* deleteSurface = walkerSurface;
+	object->prev = 0;
+	object->next = 0;
+}
 
-					if (tempSurface == 0)
-					{
-						walkerDpy->rootSurface = deleteSurface->next;
+// Moves a destroyed object from the live list to the retire list of its display. Needs the display lock. The retire
+// list is linked through the object itself, so retiring allocates nothing and can not fail.
+template<typename T>
+static void _eglInternalRetire(T** root, T** retired, T* object)
+{
+	_eglInternalUnlink(root, object);
 
-						walkerSurface = walkerDpy->rootSurface;
-					}
-					else
-					{
-						tempSurface->next = deleteSurface->next;
+	_eglInternalLink(retired, object);
 
-						walkerSurface = tempSurface;
-					}
+	g_globalStorage.retiredCount++;
+}
 
-					free(deleteSurface);
-				}
+// Reclaims the retired objects, for which reclaim returns true. The others are kept for a later cleanup.
+template<typename T, typename F>
+static void _eglInternalReclaim(T** retired, F reclaim)
+{
+	T* walker = *retired;
 
-				tempSurface = walkerSurface;
+	while (walker)
+	{
+		T* object = walker;
 
-				if (walkerSurface)
-					walkerSurface = walkerSurface->next;
-			}
+		walker = walker->next;
 
-			while (walkerCtx)
-			{
-				// Avoid deleting of a shared context.
-				/*EGLContextImpl* innerWalkerCtx = walkerDpy->rootCtx;
-				while (innerWalkerCtx)
-				{
-					if (innerWalkerCtx->sharedCtx == walkerCtx)
-					{
-						continue;
-					}
+		// Unlinked before, as reclaim frees the object.
+		_eglInternalUnlink(retired, object);
 
-					innerWalkerCtx = innerWalkerCtx->next;
-				}*/
+		if (reclaim(object))
+		{
+			g_globalStorage.retiredCount--;
+		}
+		else
+		{
+			_eglInternalLink(retired, object);
+		}
+	}
+}
 
-				if (walkerCtx->destroy && walkerCtx != walkerDpy->currentCtx && walkerCtx != g_localStorage.currentCtx)
-				{
-					EGLContextImpl* deleteCtx = walkerCtx;
+extern "C" 
+{
 
-					if (tempCtx == 0)
-					{
-						walkerDpy->rootCtx = deleteCtx->next;
+static EGLBoolean _eglInternalInit()
+{
+	auto dummy = g_globalStorage.dummy_read();
+	EGLBoolean r = __internalInit(&dummy);
+	g_globalStorage.dummy_write(dummy);
 
-						walkerCtx = walkerDpy->rootCtx;
-					}
-					else
-					{
-						tempCtx->next = deleteCtx->next;
+	return r;
+}
 
-						walkerCtx = tempCtx;
-					}
+static EGLint _eglInternalCompareVersion(const EGLint* version, EGLint major, EGLint minor)
+{
+	if (version[0] != major)
+	{
+		return version[0] < major ? -1 : 1;
+	}
 
-					// Freeing the context.
-					while (deleteCtx->rootCtxList)
-					{
-						EGLContextListImpl* deleteCtxList = deleteCtx->rootCtxList;
+	if (version[1] != minor)
+	{
+		return version[1] < minor ? -1 : 1;
+	}
 
-						deleteCtx->rootCtxList = deleteCtx->rootCtxList->next;
+	return 0;
+}
 
-						__deleteContext(walkerDpy, &deleteCtxList->nativeContextContainer);
+// Answers from the known bounds alone. Returns false, if the version has to be probed.
+static EGLBoolean _eglInternalKnownVersion(const EGLVersionBounds* bounds, EGLint major, EGLint minor, EGLBoolean* supported)
+{
+	if (bounds->supported[0] != 0 && _eglInternalCompareVersion(bounds->supported, major, minor) >= 0)
+	{
+		*supported = EGL_TRUE;
 
-						free(deleteCtxList);
-					}
+		return EGL_TRUE;
+	}
 
-					free(deleteCtx);
-				}
+	if (bounds->unsupported[0] != 0 && _eglInternalCompareVersion(bounds->unsupported, major, minor) <= 0)
+	{
+		*supported = EGL_FALSE;
 
-				tempCtx = walkerCtx;
+		return EGL_TRUE;
+	}
 
-				if (walkerCtx)
-				{
-					walkerCtx = walkerCtx->next;
-				}
-			}
+	return EGL_FALSE;
+}
 
-			if (walkerDpy->destroy)
-			{
-				if (walkerDpy->rootSurface == 0 && walkerDpy->rootCtx == 0 && walkerDpy->currentDraw == EGL_NO_SURFACE && walkerDpy->currentRead == EGL_NO_SURFACE && walkerDpy->currentCtx == EGL_NO_CONTEXT)
-				{
-					EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+// Probes the version with the attributes of the context and narrows the bounds. Creates native contexts, so it is
+// called without the display lock.
+static EGLBoolean _eglInternalProbeVersion(const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, const NativeLocalStorageContainer* dummy, EGLenum api, const EGLint* attribList, EGLVersionBounds* bounds, EGLint major, EGLint minor)
+{
+	EGLint* supported = bounds->supported;
+	EGLint* unsupported = bounds->unsupported;
 
-					EGLConfigImpl* deleteConfig;
+	if (__probeContextVersion(walkerDpy, walkerConfig, dummy, attribList, major, minor))
+	{
+		supported[0] = major;
+		supported[1] = minor;
 
-					while (walkerConfig)
-					{
-						deleteConfig = walkerConfig;
+		return EGL_TRUE;
+	}
 
-						walkerConfig = walkerConfig->next;
+	unsupported[0] = major;
+	unsupported[1] = minor;
 
-						free(deleteConfig);
-					}
-					walkerDpy->rootConfig = 0;
+	// Binary search the known versions between both bounds, so later requests are answered without probing.
 
-					//
+	const EGLint (*versions)[2] = (api == EGL_OPENGL_ES_API) ? g_ES_versions : g_GL_versions;
+	const EGLint numberVersions = (api == EGL_OPENGL_ES_API) ? (EGLint)(sizeof(g_ES_versions) / sizeof(g_ES_versions[0])) : (EGLint)(sizeof(g_GL_versions) / sizeof(g_GL_versions[0]));
 
-					EGLDisplayImpl* deleteDpy = walkerDpy;
+	EGLint low = 0;
+	EGLint high = numberVersions - 1;
 
-					if (tempDpy == 0)
-					{
-						g_globalStorage.rootDpy = deleteDpy->next;
+	while (low <= high && supported[0] != 0 && _eglInternalCompareVersion(versions[low], supported[0], supported[1]) <= 0)
+	{
+		low++;
+	}
 
-						walkerDpy = g_globalStorage.rootDpy;
-					}
-					else
-					{
-						tempDpy->next = deleteDpy->next;
+	while (low <= high && _eglInternalCompareVersion(versions[high], unsupported[0], unsupported[1]) >= 0)
+	{
+		high--;
+	}
 
-						walkerDpy = tempDpy;
-					}
+	while (low <= high)
+	{
+		const EGLint middle = low + (high - low) / 2;
 
-					delete deleteDpy;
-				}
-			}
+		if (__probeContextVersion(walkerDpy, walkerConfig, dummy, attribList, versions[middle][0], versions[middle][1]))
+		{
+			supported[0] = versions[middle][0];
+			supported[1] = versions[middle][1];
 
-			tempDpy = walkerDpy;
+			low = middle + 1;
+		}
+		else
+		{
+			unsupported[0] = versions[middle][0];
+			unsupported[1] = versions[middle][1];
 
-			if (walkerDpy)
-			{
-				walkerDpy = walkerDpy->next;
-			}
+			high = middle - 1;
 		}
 	}
 
-	if (!g_globalStorage.rootDpy)
-	{
-		_eglInternalTerminate();
-	}
+	return EGL_FALSE;
 }
 
-void _eglInternalSetDefaultConfig(EGLConfigImpl* config)
+// Merges probed bounds into the known ones, which another thread may have narrowed meanwhile.
+static void _eglInternalMergeVersionBounds(EGLVersionBounds* bounds, const EGLVersionBounds* probed)
 {
-	if (!config)
+	if (probed->supported[0] != 0 && (bounds->supported[0] == 0 || _eglInternalCompareVersion(bounds->supported, probed->supported[0], probed->supported[1]) < 0))
 	{
-		return;
+		bounds->supported[0] = probed->supported[0];
+		bounds->supported[1] = probed->supported[1];
 	}
 
-	config->alphaSize = 0;
-	config->alphaMaskSize = 0;
+	if (probed->unsupported[0] != 0 && (bounds->unsupported[0] == 0 || _eglInternalCompareVersion(bounds->unsupported, probed->unsupported[0], probed->unsupported[1]) > 0))
+	{
+		bounds->unsupported[0] = probed->unsupported[0];
+		bounds->unsupported[1] = probed->unsupported[1];
+	}
+}
 
-	config->bindToTextureRGB = EGL_DONT_CARE;
-	config->bindToTextureRGBA = EGL_DONT_CARE;
-	config->blueSize = 0;
-	config->bufferSize = 0;
+// Needs a current context, as wglGetProcAddress fails without one.
+static const GLSyncFunctions* _eglInternalGetSyncFunctions()
+{
+	static const GLSyncFunctions functions = {
+		(__PFN_glFenceSync)__getProcAddress("glFenceSync"),
+		(__PFN_glDeleteSync)__getProcAddress("glDeleteSync"),
+		(__PFN_glClientWaitSync)__getProcAddress("glClientWaitSync"),
+		(__PFN_glGetSynciv)__getProcAddress("glGetSynciv"),
+		(__PFN_glWaitSync)__getProcAddress("glWaitSync"),
+		(__PFN_glFlush)__getProcAddress("glFlush")
+	};
 
-	config->colorBufferType = EGL_DONT_CARE;
-	config->configCaveat = EGL_DONT_CARE;
-	config->configId = EGL_DONT_CARE;
-	config->conformant = 0;
+	if (!functions.fenceSync || !functions.deleteSync || !functions.clientWaitSync || !functions.getSynciv || !functions.waitSync || !functions.flush)
+	{
+		return 0;
+	}
 
-	config->depthSize = 0;
+	return &functions;
+}
 
-	config->greenSize = 0;
+// GL commands on the fence of the sync are only valid, if a context of its share group is current.
+static EGLBoolean _eglInternalCanAccessFence(const EGLSyncImpl* walkerSync)
+{
+	return walkerSync->fence && g_localStorage.currentCtx != EGL_NO_CONTEXT && g_localStorage.currentCtx->shareGroup == walkerSync->shareGroup;
+}
 
-	config->level = 0;
-	config->luminanceSize = 0;
+// Drops a reference to the share group. The last one deletes it. Needs the display lock.
+static void _eglInternalReleaseShareGroup(EGLShareGroupImpl* shareGroup)
+{
+	if (!shareGroup || --shareGroup->refCount > 0)
+	{
+		return;
+	}
 
-	config->matchNativePixmap = EGL_NONE;
-	config->maxPBufferHeight = EGL_DONT_CARE;
-	config->maxPBufferPixels = EGL_DONT_CARE;
-	config->maxPBufferWidth = EGL_DONT_CARE;
-	config->maxSwapInterval = EGL_DONT_CARE;
-	config->minSwapInterval = EGL_DONT_CARE;
+	delete shareGroup;
+}
 
-	config->nativeRenderable = EGL_DONT_CARE;
-	config->nativeVisualId = 0;
-	config->nativeVisualType = EGL_NONE;
+// Needs a current context, as wglGetProcAddress fails without one.
+static const GLImageFunctions* _eglInternalGetImageFunctions()
+{
+	static const GLImageFunctions functions = {
+		(__PFN_glIsTexture)__getProcAddress("glIsTexture"),
+		(__PFN_glIsRenderbuffer)__getProcAddress("glIsRenderbuffer"),
+		(__PFN_glBindTexture)__getProcAddress("glBindTexture"),
+		(__PFN_glBindRenderbuffer)__getProcAddress("glBindRenderbuffer"),
+		(__PFN_glGetIntegerv)__getProcAddress("glGetIntegerv"),
+		(__PFN_glGetTexParameteriv)__getProcAddress("glGetTexParameteriv"),
+		(__PFN_glGetTexLevelParameteriv)__getProcAddress("glGetTexLevelParameteriv"),
+		(__PFN_glGetRenderbufferParameteriv)__getProcAddress("glGetRenderbufferParameteriv")
+	};
 
-	config->redSize = 0;
-	config->renderableType = EGL_OPENGL_ES_BIT;
+	if (!functions.isTexture || !functions.isRenderbuffer || !functions.bindTexture || !functions.bindRenderbuffer || !functions.getIntegerv ||
+		!functions.getTexParameteriv || !functions.getTexLevelParameteriv || !functions.getRenderbufferParameteriv)
+	{
+		return 0;
+	}
 
-	config->sampleBuffers = 0;
-	config->samples = 0;
-	config->stencilSize = 0;
-	config->surfaceType = EGL_WINDOW_BIT;
+	return &functions;
+}
 
-	config->transparentBlueValue = EGL_DONT_CARE;
-	config->transparentGreenValue = EGL_DONT_CARE;
-	config->transparentRedValue = EGL_DONT_CARE;
-	config->transparentType = EGL_NONE;
+// Whether the texture bound to GL_TEXTURE_2D can be sampled with its minification filter.
+static bool _eglInternalIsTextureComplete(const GLImageFunctions* gl)
+{
+	GLint baseLevel = 0;
+	GLint maxLevel = 0;
+	GLint minFilter = 0;
 
-	//
+	gl->getTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &baseLevel);
+	gl->getTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+	gl->getTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
 
-	config->drawToWindow = EGL_TRUE;
-	config->drawToPixmap = EGL_FALSE;
-	config->drawToPBuffer = EGL_FALSE;
-	config->doubleBuffer = EGL_TRUE;
+	GLint width = 0;
+	GLint height = 0;
+	GLint internalFormat = 0;
 
-	config->next = 0;
-}
+	gl->getTexLevelParameteriv(GL_TEXTURE_2D, baseLevel, GL_TEXTURE_WIDTH, &width);
+	gl->getTexLevelParameteriv(GL_TEXTURE_2D, baseLevel, GL_TEXTURE_HEIGHT, &height);
+	gl->getTexLevelParameteriv(GL_TEXTURE_2D, baseLevel, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
 
-static void _eglInternalSetDontCareConfig(EGLConfigImpl* config)
-{
-	if (!config)
+	if (width <= 0 || height <= 0)
 	{
-		return;
+		return false;
 	}
 
-	// Set default values
+	if (minFilter == GL_NEAREST || minFilter == GL_LINEAR)
+	{
+		return true;
+	}
 
-	config->alphaSize = EGL_DONT_CARE;
-	config->alphaMaskSize = EGL_DONT_CARE;
+	// Every level down to 1x1 has to be there, with half the size and the same format.
+	for (GLint level = baseLevel + 1; level <= maxLevel && (width > 1 || height > 1); level++)
+	{
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
 
-	config->bindToTextureRGB = EGL_DONT_CARE;
-	config->bindToTextureRGBA = EGL_DONT_CARE;
-	config->blueSize = EGL_DONT_CARE;
-	config->bufferSize = EGL_DONT_CARE;
+		GLint levelWidth = 0;
+		GLint levelHeight = 0;
+		GLint levelFormat = 0;
 
-	config->colorBufferType = EGL_RGB_BUFFER;
-	config->configCaveat = EGL_DONT_CARE;
-	config->configId = EGL_DONT_CARE;
-	config->conformant = EGL_DONT_CARE;
+		gl->getTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &levelWidth);
+		gl->getTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &levelHeight);
+		gl->getTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_INTERNAL_FORMAT, &levelFormat);
 
-	config->depthSize = EGL_DONT_CARE;
+		if (levelWidth != width || levelHeight != height || levelFormat != internalFormat)
+		{
+			return false;
+		}
+	}
 
-	config->greenSize = EGL_DONT_CARE;
+	return true;
+}
 
-	config->level = EGL_DONT_CARE;
-	config->luminanceSize = EGL_DONT_CARE;
+// Checks the texture or renderbuffer of an image, as EGL_KHR_gl_texture_2D_image and EGL_KHR_gl_renderbuffer_image
+// require. Runs in a context, which can access the object, and whose bindings are restored. Returns EGL_SUCCESS or the
+// error for eglCreateImage.
+static EGLint _eglInternalCheckImageSource(const GLImageFunctions* gl, const EGLImageImpl* walkerImage)
+{
+	const GLuint name = (GLuint)(uintptr_t)walkerImage->buffer;
 
-	config->matchNativePixmap = EGL_DONT_CARE;
-	config->maxPBufferHeight = EGL_DONT_CARE;
-	config->maxPBufferPixels = EGL_DONT_CARE;
-	config->maxPBufferWidth = EGL_DONT_CARE;
-	config->maxSwapInterval = EGL_DONT_CARE;
-	config->minSwapInterval = EGL_DONT_CARE;
+	GLint previousName = 0;
 
-	config->nativeRenderable = EGL_DONT_CARE;
-	config->nativeVisualId = EGL_DONT_CARE;
-	config->nativeVisualType = EGL_DONT_CARE;
+	GLint width = 0;
+	GLint height = 0;
 
-	config->redSize = EGL_DONT_CARE;
-	config->renderableType = EGL_DONT_CARE;
+	if (walkerImage->target == EGL_GL_RENDERBUFFER)
+	{
+		if (!gl->isRenderbuffer(name))
+		{
+			return EGL_BAD_PARAMETER;
+		}
 
-	config->sampleBuffers = EGL_DONT_CARE;
-	config->samples = EGL_DONT_CARE;
-	config->stencilSize = EGL_DONT_CARE;
-	config->surfaceType = EGL_WINDOW_BIT;
+		GLint samples = 0;
 
-	config->transparentBlueValue = EGL_DONT_CARE;
-	config->transparentGreenValue = EGL_DONT_CARE;
-	config->transparentRedValue = EGL_DONT_CARE;
-	config->transparentType = EGL_DONT_CARE;
+		gl->getIntegerv(GL_RENDERBUFFER_BINDING, &previousName);
+		gl->bindRenderbuffer(GL_RENDERBUFFER, name);
 
-	// Following parameters always do care.
+		gl->getRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &width);
+		gl->getRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &height);
+		gl->getRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_SAMPLES, &samples);
 
-	config->drawToWindow = EGL_TRUE;
-	config->drawToPixmap = EGL_FALSE;
-	config->drawToPBuffer = EGL_FALSE;
+		gl->bindRenderbuffer(GL_RENDERBUFFER, (GLuint)previousName);
 
-	config->doubleBuffer = EGL_TRUE;
+		if (samples > 0)
+		{
+			return EGL_BAD_PARAMETER;
+		}
+	}
+	else
+	{
+		if (!gl->isTexture(name))
+		{
+			return EGL_BAD_PARAMETER;
+		}
 
-	config->next = 0;
+		GLint boundName = 0;
+
+		gl->getIntegerv(GL_TEXTURE_BINDING_2D, &previousName);
+		gl->bindTexture(GL_TEXTURE_2D, name);
+
+		// Binding a texture of another target fails and keeps the binding.
+		gl->getIntegerv(GL_TEXTURE_BINDING_2D, &boundName);
+
+		if ((GLuint)boundName != name)
+		{
+			return EGL_BAD_PARAMETER;
+		}
+
+		GLint mipmapWidth = 0;
+
+		gl->getTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+		gl->getTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+		gl->getTexLevelParameteriv(GL_TEXTURE_2D, 1, GL_TEXTURE_WIDTH, &mipmapWidth);
+
+		// Level 0 may be used alone, but not out of an incomplete mipmap chain.
+		const bool complete = mipmapWidth <= 0 || _eglInternalIsTextureComplete(gl);
+
+		gl->bindTexture(GL_TEXTURE_2D, (GLuint)previousName);
+
+		if (!complete)
+		{
+			return EGL_BAD_PARAMETER;
+		}
+	}
+
+	if (width <= 0 || height <= 0)
+	{
+		return EGL_BAD_PARAMETER;
+	}
+
+	return EGL_SUCCESS;
 }
 
 //
-// EGL_VERSION_1_0
+// Reusable syncs block on their status word: A futex on Linux, WaitOnAddress on Windows.
 //
 
-static int _ChooseConfig_sort_predicate(const void* _lhs, const void* _rhs)
+static_assert(sizeof(std::atomic<EGLint>) == sizeof(EGLint), "The sync status is waited on as a plain integer.");
+
+static void _eglInternalWakeSync(EGLSyncImpl* walkerSync)
 {
-	const EGLConfigImpl* lhs = *(const EGLConfigImpl**)_lhs;
-	const EGLConfigImpl* rhs = *(const EGLConfigImpl**)_rhs;
+#if defined(__linux__)
+	syscall(SYS_futex, (EGLint*)&walkerSync->status, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#elif defined(_WIN32) || defined(_WIN64)
+	WakeByAddressAll((PVOID)&walkerSync->status);
+#else
+	(void)walkerSync;
+#endif
+}
 
-	if (lhs->configCaveat == rhs->configCaveat)
+// Returns EGL_CONDITION_SATISFIED or EGL_TIMEOUT_EXPIRED. The timeout is relative and in nanoseconds.
+static EGLint _eglInternalWaitSync(EGLSyncImpl* walkerSync, EGLTime timeout)
+{
+	const bool forever = timeout == EGL_FOREVER || timeout > (EGLTime)std::chrono::nanoseconds::max().count() / 2;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(forever ? 0 : (int64_t)timeout);
+
+	while (walkerSync->status.load() != EGL_SIGNALED)
 	{
-		if (lhs->colorBufferType == rhs->colorBufferType)
+		int64_t remaining = 0;
+
+		if (!forever)
 		{
-			EGLint color_bits[2] = { 0, 0 };
-			switch (lhs->colorBufferType)
-			{
-			case EGL_RGB_BUFFER:
-				color_bits[0] = lhs->redSize + lhs->greenSize + lhs->blueSize + lhs->alphaSize;
-				color_bits[1] = rhs->redSize + rhs->greenSize + rhs->blueSize + rhs->alphaSize;
-				break;
-			case EGL_LUMINANCE_BUFFER:
-				color_bits[0] = lhs->luminanceSize + lhs->alphaSize;
-				color_bits[1] = rhs->luminanceSize + rhs->alphaSize;
-				break;
-			default:
-				break;
-			}
+			remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now()).count();
 
-			if (color_bits[0] == color_bits[1])
+			if (remaining <= 0)
 			{
-				if (lhs->bufferSize == rhs->bufferSize)
-				{
-					if (lhs->sampleBuffers == rhs->sampleBuffers)
-					{
-						if (lhs->samples == rhs->samples)
-						{
-							if (lhs->depthSize == rhs->depthSize)
-							{
-								if (lhs->stencilSize == rhs->stencilSize)
-								{
-									if (lhs->alphaMaskSize == rhs->alphaMaskSize)
-									{
-										// skip rule 10 since it's impl-defined
-										// 10. Special: EGL_NATIVE_VISUAL_TYPE (the actual sort order is implementation-defined, depending on the meaning of native visual types).
-
-										// 11. Smaller EGL_CONFIG_ID (guarantees a unique ordering)
-										return (lhs->configId - rhs->configId);
-									}
-									else return (lhs->alphaMaskSize - rhs->alphaMaskSize); // 9. Smaller EGL_ALPHA_MASK_SIZE
-								}
-								else return (lhs->stencilSize - rhs->stencilSize); // 8. Smaller EGL_STENCIL_SIZE
-							}
-							else return (lhs->depthSize - rhs->depthSize); // 7. Smaller EGL_DEPTH_SIZE
-						}
-						else return (lhs->samples - rhs->samples); // 6. Smaller EGL_SAMPLES
-					}
-					else return (lhs->sampleBuffers - rhs->sampleBuffers); // 5. Smaller EGL_SAMPLE_BUFFERS
-				}
-				else return (lhs->bufferSize - rhs->bufferSize); // 4. Smaller EGL_BUFFER_SIZE
+				return EGL_TIMEOUT_EXPIRED;
 			}
-			else return color_bits[1] - color_bits[0]; // 3. by larger total number of color bits
 		}
-		else return (lhs->colorBufferType - rhs->colorBufferType); // 2. by EGL_COLOR_BUFFER_TYPE
+
+#if defined(__linux__)
+		struct timespec ts;
+		ts.tv_sec = (time_t)(remaining / 1000000000);
+		ts.tv_nsec = (long)(remaining % 1000000000);
+
+		// Returns at once, if the status changed in the meantime.
+		syscall(SYS_futex, (EGLint*)&walkerSync->status, FUTEX_WAIT_PRIVATE, EGL_UNSIGNALED, forever ? NULL : &ts, NULL, 0);
+#elif defined(_WIN32) || defined(_WIN64)
+		EGLint unsignaled = EGL_UNSIGNALED;
+		WaitOnAddress((volatile VOID*)&walkerSync->status, &unsignaled, sizeof(unsignaled), forever ? INFINITE : (DWORD)std::min<int64_t>((remaining + 999999) / 1000000, INFINITE - 1));
+#else
+		std::this_thread::yield();
+#endif
 	}
-	else return (lhs->configCaveat - rhs->configCaveat); // 1. by EGL_CONFIG_CAVEAT
+
+	return EGL_CONDITION_SATISFIED;
 }
 
-EGLBoolean _eglChooseConfig(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig *configs, EGLint config_size, EGLint *num_config)
+// Blocks, until the commands of the current context are complete. Sleeps on a fence instead of glFinish, if possible.
+static void _eglInternalFinish()
 {
-	if (!attrib_list)
+	const GLSyncFunctions* gl = _eglInternalGetSyncFunctions();
+
+	void* fence = gl ? gl->fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : 0;
+
+	if (!fence)
 	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+		glFinish();
 
-		return EGL_FALSE;
+		return;
 	}
 
-	if (!configs)
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	GLenum result;
+	do
 	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+		result = gl->clientWaitSync(fence, flags, GL_TIMEOUT_IGNORED);
+		flags = 0;
+	}
+	while (result == GL_TIMEOUT_EXPIRED);
 
-		return EGL_FALSE;
+	gl->deleteSync(fence);
+}
+
+static void _eglInternalTerminate()
+{
+	auto dummy = g_globalStorage.dummy_read();
+	__internalTerminate(&dummy);
+	g_globalStorage.dummy_write(dummy);
+}
+
+static void _eglInternalClearConfigStore(EGLConfigStore* store)
+{
+	store->count = 0;
+	store->paddedCount = 0;
+	store->configs.clear();
+	store->columns.clear();
+	store->matchMask.clear();
+	store->matches.clear();
+}
+
+static const EGLConfigImpl* _eglInternalFindConfig(const EGLDisplayImpl* walkerDpy, EGLint configId)
+{
+	const EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+
+	while (walkerConfig && walkerConfig->configId != configId)
+	{
+		walkerConfig = walkerConfig->next;
 	}
 
-	if (config_size == 0)
+	return walkerConfig;
+}
+
+// Native context to share with, preferably one on the connection of the new context.
+static const NativeContextContainer* _eglInternalShareContext(const EGLContextListImpl* ctxList, const NativeSurfaceContainer* nativeSurfaceContainer)
+{
+	for (const EGLContextListImpl* walkerCtxList = ctxList; walkerCtxList; walkerCtxList = walkerCtxList->next)
 	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+		if (__isCompatibleContext(&walkerCtxList->nativeContextContainer, nativeSurfaceContainer, EGL_FALSE))
+		{
+			return &walkerCtxList->nativeContextContainer;
+		}
+	}
+
+	return ctxList ? &ctxList->nativeContextContainer : 0;
+}
 
+// A native context created for one configuration can be bound to drawables of the other.
+static EGLBoolean _eglInternalCompatibleConfigs(const EGLConfigImpl* lhs, const EGLConfigImpl* rhs)
+{
+	if (!lhs || !rhs)
+	{
 		return EGL_FALSE;
 	}
 
-	if (!num_config)
+	return lhs->colorBufferType == rhs->colorBufferType &&
+		lhs->redSize == rhs->redSize && lhs->greenSize == rhs->greenSize && lhs->blueSize == rhs->blueSize && lhs->alphaSize == rhs->alphaSize &&
+		lhs->depthSize == rhs->depthSize && lhs->stencilSize == rhs->stencilSize &&
+		lhs->sampleBuffers == rhs->sampleBuffers && lhs->samples == rhs->samples;
+}
+
+// Pins the objects of a binding, so cleanup keeps them while native calls run outside of the display lock. Has to be
+// called with the display locked, as cleanup decides on the counters under the display lock.
+static void _eglInternalAcquireCurrent(EGLDisplayImpl* walkerDpy, EGLSurfaceImpl* currentDraw, EGLSurfaceImpl* currentRead, EGLContextImpl* currentCtx)
+{
+	walkerDpy->currentCount++;
+
+	if (currentCtx != EGL_NO_CONTEXT)
 	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+		currentCtx->currentCount++;
+	}
+	if (currentDraw != EGL_NO_SURFACE)
+	{
+		currentDraw->currentCount++;
+	}
+	if (currentRead != EGL_NO_SURFACE)
+	{
+		currentRead->currentCount++;
+	}
+}
 
-		return EGL_FALSE;
+// Unpins the objects of a binding. Does not need the display lock, so a thread can drop bindings of another display.
+static void _eglInternalReleaseCurrent(EGLDisplayImpl* walkerDpy, EGLSurfaceImpl* currentDraw, EGLSurfaceImpl* currentRead, EGLContextImpl* currentCtx)
+{
+	if (currentRead != EGL_NO_SURFACE)
+	{
+		currentRead->currentCount--;
+	}
+	if (currentDraw != EGL_NO_SURFACE)
+	{
+		currentDraw->currentCount--;
+	}
+	if (currentCtx != EGL_NO_CONTEXT)
+	{
+		currentCtx->currentCount--;
 	}
 
-	auto _rl = g_globalStorage.placeRootDpy_readlock();
-	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+	walkerDpy->currentCount--;
+}
 
-	while (walkerDpy)
+// Replaces the current bindings of the calling thread with already acquired ones.
+static void _eglInternalSetCurrent(EGLDisplayImpl* walkerDpy, EGLSurfaceImpl* currentDraw, EGLSurfaceImpl* currentRead, EGLContextImpl* currentCtx)
+{
+	if (g_localStorage.currentCtx != EGL_NO_CONTEXT)
 	{
-		if ((EGLDisplay)walkerDpy == dpy)
+		_eglInternalReleaseCurrent(g_localStorage.currentDpy, g_localStorage.currentDraw, g_localStorage.currentRead, g_localStorage.currentCtx);
+	}
+
+	if (currentCtx != EGL_NO_CONTEXT)
+	{
+		g_localStorage.currentDpy = walkerDpy;
+		g_localStorage.currentDraw = currentDraw;
+		g_localStorage.currentRead = currentRead;
+	}
+	else
+	{
+		// Releasing only pinned the display for the native call.
+		_eglInternalReleaseCurrent(walkerDpy, EGL_NO_SURFACE_IMPL, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
+
+		g_localStorage.currentDpy = 0;
+		g_localStorage.currentDraw = EGL_NO_SURFACE_IMPL;
+		g_localStorage.currentRead = EGL_NO_SURFACE_IMPL;
+	}
+	g_localStorage.currentCtx = currentCtx;
+}
+
+// Frees the retired objects of a display, which are no longer in use. Only the retire lists are visited. Needs the
+// display lock. Native calls can block, so surfaces and native contexts are only collected into the given lists, linked
+// through next, and destroyed by _eglInternalDestroyReclaimed without the locks.
+static void _eglInternalReclaimDisplay(EGLDisplayImpl* walkerDpy, EGLSurfaceImpl** deleteSurfaces, EGLContextListImpl** deleteCtxLists)
+{
+	_eglInternalReclaim(&walkerDpy->retiredSurfaces, [walkerDpy, deleteSurfaces](EGLSurfaceImpl* deleteSurface)
+	{
+		if (deleteSurface->currentCount != 0)
 		{
-			guard_t _{ walkerDpy->mutex };
+			return false;
+		}
 
-			if (!walkerDpy->initialized || walkerDpy->destroy)
-			{
-				g_localStorage.error = EGL_NOT_INITIALIZED;
+		walkerDpy->surfaceTable.remove(deleteSurface->handle);
 
-				return EGL_FALSE;
-			}
+		deleteSurface->next = *deleteSurfaces;
+		*deleteSurfaces = deleteSurface;
 
-			EGLint attribListIndex = 0;
+		return true;
+	});
 
-			EGLConfigImpl config;
+	_eglInternalReclaim(&walkerDpy->retiredCtxs, [walkerDpy, deleteCtxLists](EGLContextImpl* deleteCtx)
+	{
+		if (deleteCtx->currentCount != 0 || deleteCtx->pendingCount != 0)
+		{
+			return false;
+		}
 
-			_eglInternalSetDefaultConfig(&config);
-			config.configCaveat = EGL_DONT_CARE; // dont care for this attribute since it cant be queried on both WGL and GLX
+		walkerDpy->ctxTable.remove(deleteCtx->handle);
 
-			while (attrib_list[attribListIndex] != EGL_NONE)
-			{
-				EGLint value = attrib_list[attribListIndex + 1];
+		// Freeing the context.
+		while (deleteCtx->rootCtxList)
+		{
+			EGLContextListImpl* deleteCtxList = deleteCtx->rootCtxList;
 
-				switch (attrib_list[attribListIndex])
-				{
-					case EGL_ALPHA_MASK_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+			deleteCtx->rootCtxList = deleteCtx->rootCtxList->next;
 
-							return EGL_FALSE;
-						}
+			deleteCtxList->next = *deleteCtxLists;
+			*deleteCtxLists = deleteCtxList;
+		}
 
-						config.alphaMaskSize = value;
-					}
-					break;
-					case EGL_ALPHA_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		_eglInternalReleaseShareGroup(deleteCtx->shareGroup);
 
-							return EGL_FALSE;
-						}
+		free(deleteCtx);
 
-						config.alphaSize = value;
-					}
-					break;
-					case EGL_BIND_TO_TEXTURE_RGB:
-					{
-						if (value != EGL_DONT_CARE && value != EGL_TRUE && value != EGL_FALSE)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		return true;
+	});
 
-							return EGL_FALSE;
-						}
-
-						config.bindToTextureRGB = value;
-					}
-					break;
-					case EGL_BIND_TO_TEXTURE_RGBA:
-					{
-						if (value != EGL_DONT_CARE && value != EGL_TRUE && value != EGL_FALSE)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+	_eglInternalReclaim(&walkerDpy->retiredSyncs, [walkerDpy](EGLSyncImpl* deleteSync)
+	{
+		// Only kept, while waits are in progress. A sync is never kept for its fence, as that would keep cleanup busy.
+		if (deleteSync->waitCount != 0)
+		{
+			return false;
+		}
 
-							return EGL_FALSE;
-						}
+		walkerDpy->syncTable.remove(deleteSync->handle);
 
-						config.bindToTextureRGBA = value;
-					}
-					break;
-					case EGL_BLUE_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		// Deleted, if a context of its share group is current. Otherwise, the fence is released together with the native
+		// contexts of its share group.
+		const GLSyncFunctions* gl = _eglInternalCanAccessFence(deleteSync) ? _eglInternalGetSyncFunctions() : 0;
 
-							return EGL_FALSE;
-						}
+		if (gl)
+		{
+			gl->deleteSync(deleteSync->fence);
+		}
 
-						config.blueSize = value;
-					}
-					break;
-					case EGL_BUFFER_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		_eglInternalReleaseShareGroup(deleteSync->shareGroup);
 
-							return EGL_FALSE;
-						}
+		free(deleteSync);
 
-						config.bufferSize = value;
-					}
-					break;
-					case EGL_COLOR_BUFFER_TYPE:
-					{
-						if (value != EGL_DONT_CARE && value != EGL_RGB_BUFFER && value != EGL_LUMINANCE_BUFFER)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		return true;
+	});
 
-							return EGL_FALSE;
-						}
+	// The texture or renderbuffer stays owned by the application.
+	_eglInternalReclaim(&walkerDpy->retiredImages, [walkerDpy](EGLImageImpl* deleteImage)
+	{
+		walkerDpy->imageTable.remove(deleteImage->handle);
 
-						config.colorBufferType = value;
-					}
-					break;
-					case EGL_CONFIG_CAVEAT:
-					{
-						if (value != EGL_DONT_CARE && value != EGL_NONE && value != EGL_SLOW_CONFIG && value != EGL_NON_CONFORMANT_CONFIG)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		_eglInternalReleaseShareGroup(deleteImage->shareGroup);
 
-							return EGL_FALSE;
-						}
+		free(deleteImage);
 
-						config.configCaveat = value;
-					}
-					break;
-					case EGL_CONFIG_ID:
-					{
-						config.configId = value;
-					}
-					break;
-					case EGL_CONFORMANT:
-					{
-						if (value != EGL_DONT_CARE && value & ~(EGL_OPENGL_BIT | EGL_OPENGL_ES_BIT | EGL_OPENGL_ES2_BIT | EGL_OPENGL_ES3_BIT | EGL_OPENVG_BIT))
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		return true;
+	});
+}
 
-							return EGL_FALSE;
-						}
+// Destroys the native objects collected by _eglInternalReclaimDisplay. Called without locks, while the display is pinned.
+static void _eglInternalDestroyReclaimed(const EGLDisplayImpl* walkerDpy, EGLSurfaceImpl* deleteSurfaces, EGLContextListImpl* deleteCtxLists)
+{
+	while (deleteSurfaces)
+	{
+		EGLSurfaceImpl* deleteSurface = deleteSurfaces;
 
-						config.conformant = value;
-					}
-					break;
-					case EGL_DEPTH_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		deleteSurfaces = deleteSurfaces->next;
 
-							return EGL_FALSE;
-						}
+		__destroySurface(deleteSurface);
 
-						config.depthSize = value;
-					}
-					break;
-					case EGL_GREEN_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		free(deleteSurface);
+	}
 
-							return EGL_FALSE;
-						}
+	while (deleteCtxLists)
+	{
+		EGLContextListImpl* deleteCtxList = deleteCtxLists;
 
-						config.greenSize = value;
-					}
-					break;
-					case EGL_LEVEL:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		deleteCtxLists = deleteCtxLists->next;
 
-							return EGL_FALSE;
-						}
+		__deleteContext(walkerDpy, &deleteCtxList->nativeContextContainer);
 
-						config.level = value;
-					}
-					break;
-					case EGL_LUMINANCE_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		free(deleteCtxList);
+	}
+}
 
-							return EGL_FALSE;
-						}
+// A terminated display is deleted, after all its objects are gone and no thread has it current anymore.
+static EGLBoolean _eglInternalCanDeleteDisplay(const EGLDisplayImpl* walkerDpy)
+{
+	return walkerDpy->destroy &&
+		walkerDpy->rootSurface == 0 && walkerDpy->rootCtx == 0 && walkerDpy->rootSync == 0 && walkerDpy->rootImage == 0 &&
+		walkerDpy->retiredSurfaces == 0 && walkerDpy->retiredCtxs == 0 && walkerDpy->retiredSyncs == 0 && walkerDpy->retiredImages == 0 &&
+		walkerDpy->currentCount == 0;
+}
 
-						config.luminanceSize = value;
-					}
-					break;
-					case EGL_MATCH_NATIVE_PIXMAP:
-					{
-						config.matchNativePixmap = value;
-					}
-					break;
-					case EGL_NATIVE_RENDERABLE:
-					{
-						if (value != EGL_DONT_CARE && value != EGL_TRUE && value != EGL_FALSE)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+static void _eglInternalCleanup()
+{
+	// Nothing retired, which is the common case after eglMakeCurrent.
+	if (g_globalStorage.retiredCount == 0)
+	{
+		return;
+	}
 
-							return EGL_FALSE;
-						}
+	size_t deleteDisplays = 0;
 
-						config.nativeRenderable = value;
-					}
-					break;
-					case EGL_MAX_SWAP_INTERVAL:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+	// Display, whose native objects are destroyed outside of the read section. It is pinned meanwhile, so it stays linked
+	// and the walk continues after it.
+	EGLDisplayImpl* reclaimDpy = 0;
 
-							return EGL_FALSE;
-						}
+	do
+	{
+		EGLSurfaceImpl* deleteSurfaces = 0;
+		EGLContextListImpl* deleteCtxLists = 0;
 
-						config.maxSwapInterval = value;
-					}
-					break;
-					case EGL_MIN_SWAP_INTERVAL:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		{
+			auto _rl = g_globalStorage.placeRootDpy_readlock();
+			EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
-							return EGL_FALSE;
-						}
+			if (reclaimDpy)
+			{
+				guard_t _{ reclaimDpy->mutex };
 
-						config.minSwapInterval = value;
-					}
-					break;
-					case EGL_RED_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+				_eglInternalReleaseCurrent(reclaimDpy, EGL_NO_SURFACE_IMPL, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
 
-							return EGL_FALSE;
-						}
+				if (_eglInternalCanDeleteDisplay(reclaimDpy))
+				{
+					deleteDisplays++;
+				}
 
-						config.redSize = value;
-					}
-					break;
-					case EGL_SAMPLE_BUFFERS:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+				walkerDpy = reclaimDpy->next;
 
-							return EGL_FALSE;
-						}
+				reclaimDpy = 0;
+			}
 
-						config.sampleBuffers = value;
-					}
-					break;
-					case EGL_SAMPLES:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+			for (; walkerDpy; walkerDpy = walkerDpy->next)
+			{
+				guard_t _{ walkerDpy->mutex };
 
-							return EGL_FALSE;
-						}
+				_eglInternalReclaimDisplay(walkerDpy, &deleteSurfaces, &deleteCtxLists);
 
-						config.samples = value;
-					}
-					break;
-					case EGL_STENCIL_SIZE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+				if (deleteSurfaces || deleteCtxLists)
+				{
+					_eglInternalAcquireCurrent(walkerDpy, EGL_NO_SURFACE_IMPL, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
 
-							return EGL_FALSE;
-						}
+					reclaimDpy = walkerDpy;
 
-						config.stencilSize = value;
-					}
 					break;
-					case EGL_RENDERABLE_TYPE:
-					{
-						if (value != EGL_DONT_CARE && value & ~(EGL_OPENGL_BIT | EGL_OPENGL_ES_BIT | EGL_OPENGL_ES2_BIT | EGL_OPENGL_ES3_BIT | EGL_OPENVG_BIT))
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+				}
 
-							return EGL_FALSE;
-						}
+				if (_eglInternalCanDeleteDisplay(walkerDpy))
+				{
+					deleteDisplays++;
+				}
+			}
+		}
 
-						config.renderableType = value;
-					}
-					break;
-					case EGL_SURFACE_TYPE:
-					{
-						if (value != EGL_DONT_CARE && value & ~(EGL_MULTISAMPLE_RESOLVE_BOX_BIT | EGL_PBUFFER_BIT | EGL_PIXMAP_BIT | EGL_SWAP_BEHAVIOR_PRESERVED_BIT | EGL_VG_ALPHA_FORMAT_PRE_BIT | EGL_VG_COLORSPACE_LINEAR_BIT | EGL_WINDOW_BIT))
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+		_eglInternalDestroyReclaimed(reclaimDpy, deleteSurfaces, deleteCtxLists);
+	}
+	while (reclaimDpy);
 
-							return EGL_FALSE;
-						}
+	if (deleteDisplays == 0)
+	{
+		return;
+	}
 
-						config.surfaceType = value;
-					}
-					break;
-					case EGL_TRANSPARENT_TYPE:
-					{
-						if (value != EGL_DONT_CARE && value != EGL_NONE && value != EGL_TRANSPARENT_TYPE)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+	EGLDisplayImpl* tempDpy = 0;
 
-							return EGL_FALSE;
-						}
+	// Displays unlinked from the list, which are deleted after all readers have left. Reserved before locking, so
+	// nothing is allocated under the lock. Displays becoming deletable meanwhile are left for a later cleanup.
+	std::vector<EGLDisplayImpl*> retiredDpys;
 
-						config.transparentType = value;
-					}
-					break;
-					case EGL_TRANSPARENT_RED_VALUE:
-					{
+	try
+	{
+		retiredDpys.reserve(deleteDisplays);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return;
+	}
+
+	{
+		auto _wl = g_globalStorage.placeRootDpy_writelock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+		while (walkerDpy)
+		{
+			std::unique_lock<std::mutex> dpyLock(walkerDpy->mutex);
+
+			// Checked again, as another thread may have made the display current meanwhile.
+			if (retiredDpys.size() < retiredDpys.capacity() && _eglInternalCanDeleteDisplay(walkerDpy))
+			{
+				EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+
+				EGLConfigImpl* deleteConfig;
+
+				while (walkerConfig)
+				{
+					deleteConfig = walkerConfig;
+
+					walkerConfig = walkerConfig->next;
+
+					free(deleteConfig);
+				}
+				walkerDpy->rootConfig = 0;
+				walkerDpy->configTable.clear();
+				_eglInternalClearConfigStore(&walkerDpy->configStore);
+
+				//
+
+				EGLDisplayImpl* deleteDpy = walkerDpy;
+
+				dpyLock.unlock();
+
+				// The next pointer of the unlinked display stays intact for readers still walking over it.
+				if (tempDpy == 0)
+				{
+					g_globalStorage.rootDpy = deleteDpy->next.load();
+
+					walkerDpy = g_globalStorage.rootDpy;
+				}
+				else
+				{
+					tempDpy->next = deleteDpy->next.load();
+
+					walkerDpy = tempDpy;
+				}
+
+				retiredDpys.push_back(deleteDpy);
+
+				g_globalStorage.retiredCount--;
+			}
+
+			if (dpyLock.owns_lock())
+			{
+				dpyLock.unlock();
+			}
+
+			tempDpy = walkerDpy;
+
+			if (walkerDpy)
+			{
+				walkerDpy = walkerDpy->next;
+			}
+		}
+
+	}
+
+	// The unlinked displays are only reachable by readers, which entered before. Waiting for them and the native calls
+	// are done after the write lock is released, so other writers are not held up.
+	if (!retiredDpys.empty())
+	{
+		g_globalStorage.rootDpy_synchronize();
+
+		for (EGLDisplayImpl* deleteDpy : retiredDpys)
+		{
+			for (const auto& shareCtx : deleteDpy->shareCtxs)
+			{
+				__deleteContext(deleteDpy, &shareCtx.second);
+			}
+
+			delete deleteDpy;
+		}
+	}
+
+	if (!g_globalStorage.rootDpy)
+	{
+		_eglInternalTerminate();
+	}
+}
+
+void _eglInternalSetDefaultConfig(EGLConfigImpl* config)
+{
+	if (!config)
+	{
+		return;
+	}
+
+	config->alphaSize = 0;
+	config->alphaMaskSize = 0;
+
+	config->bindToTextureRGB = EGL_DONT_CARE;
+	config->bindToTextureRGBA = EGL_DONT_CARE;
+	config->blueSize = 0;
+	config->bufferSize = 0;
+
+	config->colorBufferType = EGL_DONT_CARE;
+	config->configCaveat = EGL_DONT_CARE;
+	config->configId = EGL_DONT_CARE;
+	config->conformant = 0;
+
+	config->depthSize = 0;
+
+	config->greenSize = 0;
+
+	config->level = 0;
+	config->luminanceSize = 0;
+
+	config->matchNativePixmap = EGL_NONE;
+	config->maxPBufferHeight = EGL_DONT_CARE;
+	config->maxPBufferPixels = EGL_DONT_CARE;
+	config->maxPBufferWidth = EGL_DONT_CARE;
+	config->maxSwapInterval = EGL_DONT_CARE;
+	config->minSwapInterval = EGL_DONT_CARE;
+
+	config->nativeRenderable = EGL_DONT_CARE;
+	config->nativeVisualId = 0;
+	config->nativeVisualType = EGL_NONE;
+
+	config->redSize = 0;
+	config->renderableType = EGL_OPENGL_ES_BIT;
+
+	config->sampleBuffers = 0;
+	config->samples = 0;
+	config->stencilSize = 0;
+	config->surfaceType = EGL_WINDOW_BIT;
+
+	config->transparentBlueValue = EGL_DONT_CARE;
+	config->transparentGreenValue = EGL_DONT_CARE;
+	config->transparentRedValue = EGL_DONT_CARE;
+	config->transparentType = EGL_NONE;
+
+	//
+
+	config->drawToWindow = EGL_TRUE;
+	config->drawToPixmap = EGL_FALSE;
+	config->drawToPBuffer = EGL_FALSE;
+	config->doubleBuffer = EGL_TRUE;
+
+	config->handle = 0;
+	memset(&config->nativeConfigContainer, 0, sizeof(config->nativeConfigContainer));
+	config->next = 0;
+}
+
+static void _eglInternalSetDontCareConfig(EGLConfigImpl* config)
+{
+	if (!config)
+	{
+		return;
+	}
+
+	// Set default values
+
+	config->alphaSize = EGL_DONT_CARE;
+	config->alphaMaskSize = EGL_DONT_CARE;
+
+	config->bindToTextureRGB = EGL_DONT_CARE;
+	config->bindToTextureRGBA = EGL_DONT_CARE;
+	config->blueSize = EGL_DONT_CARE;
+	config->bufferSize = EGL_DONT_CARE;
+
+	config->colorBufferType = EGL_RGB_BUFFER;
+	config->configCaveat = EGL_DONT_CARE;
+	config->configId = EGL_DONT_CARE;
+	config->conformant = EGL_DONT_CARE;
+
+	config->depthSize = EGL_DONT_CARE;
+
+	config->greenSize = EGL_DONT_CARE;
+
+	config->level = EGL_DONT_CARE;
+	config->luminanceSize = EGL_DONT_CARE;
+
+	config->matchNativePixmap = EGL_DONT_CARE;
+	config->maxPBufferHeight = EGL_DONT_CARE;
+	config->maxPBufferPixels = EGL_DONT_CARE;
+	config->maxPBufferWidth = EGL_DONT_CARE;
+	config->maxSwapInterval = EGL_DONT_CARE;
+	config->minSwapInterval = EGL_DONT_CARE;
+
+	config->nativeRenderable = EGL_DONT_CARE;
+	config->nativeVisualId = EGL_DONT_CARE;
+	config->nativeVisualType = EGL_DONT_CARE;
+
+	config->redSize = EGL_DONT_CARE;
+	config->renderableType = EGL_DONT_CARE;
+
+	config->sampleBuffers = EGL_DONT_CARE;
+	config->samples = EGL_DONT_CARE;
+	config->stencilSize = EGL_DONT_CARE;
+	config->surfaceType = EGL_WINDOW_BIT;
+
+	config->transparentBlueValue = EGL_DONT_CARE;
+	config->transparentGreenValue = EGL_DONT_CARE;
+	config->transparentRedValue = EGL_DONT_CARE;
+	config->transparentType = EGL_DONT_CARE;
+
+	// Following parameters always do care.
+
+	config->drawToWindow = EGL_TRUE;
+	config->drawToPixmap = EGL_FALSE;
+	config->drawToPBuffer = EGL_FALSE;
+
+	config->doubleBuffer = EGL_TRUE;
+
+	config->handle = 0;
+	memset(&config->nativeConfigContainer, 0, sizeof(config->nativeConfigContainer));
+	config->next = 0;
+}
+
+//
+// Configuration filter. Each kernel clears the mask of every configuration, whose column value fails the criterion.
+// The column length is a multiple of EGL_CONFIG_STORE_LANES.
+//
+
+typedef void (*_EGLConfigFilterKernel)(EGLint* mask, const EGLint* column, EGLint value, EGLint count);
+
+typedef struct _EGLConfigFilterKernels
+{
+	// column >= value
+	_EGLConfigFilterKernel atLeast;
+	// column == value
+	_EGLConfigFilterKernel equal;
+	// (column & value) == value
+	_EGLConfigFilterKernel contains;
+} EGLConfigFilterKernels;
+
+#if defined(EGL_CONFIG_FILTER_SSE2)
+static void _eglInternalFilterAtLeastSSE2(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	const __m128i v = _mm_set1_epi32(value);
+
+	for (EGLint i = 0; i < count; i += 4)
+	{
+		__m128i m = _mm_loadu_si128((const __m128i*)(mask + i));
+		__m128i c = _mm_loadu_si128((const __m128i*)(column + i));
+
+		// Fails, if value > column.
+		m = _mm_andnot_si128(_mm_cmpgt_epi32(v, c), m);
+
+		_mm_storeu_si128((__m128i*)(mask + i), m);
+	}
+}
+
+static void _eglInternalFilterEqualSSE2(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	const __m128i v = _mm_set1_epi32(value);
+
+	for (EGLint i = 0; i < count; i += 4)
+	{
+		__m128i m = _mm_loadu_si128((const __m128i*)(mask + i));
+		__m128i c = _mm_loadu_si128((const __m128i*)(column + i));
+
+		m = _mm_and_si128(_mm_cmpeq_epi32(c, v), m);
+
+		_mm_storeu_si128((__m128i*)(mask + i), m);
+	}
+}
+
+static void _eglInternalFilterContainsSSE2(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	const __m128i v = _mm_set1_epi32(value);
+
+	for (EGLint i = 0; i < count; i += 4)
+	{
+		__m128i m = _mm_loadu_si128((const __m128i*)(mask + i));
+		__m128i c = _mm_loadu_si128((const __m128i*)(column + i));
+
+		m = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(c, v), v), m);
+
+		_mm_storeu_si128((__m128i*)(mask + i), m);
+	}
+}
+#else
+static void _eglInternalFilterAtLeast(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	for (EGLint i = 0; i < count; i++)
+	{
+		mask[i] &= -(EGLint)(column[i] >= value);
+	}
+}
+
+static void _eglInternalFilterEqual(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	for (EGLint i = 0; i < count; i++)
+	{
+		mask[i] &= -(EGLint)(column[i] == value);
+	}
+}
+
+static void _eglInternalFilterContains(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	for (EGLint i = 0; i < count; i++)
+	{
+		mask[i] &= -(EGLint)((column[i] & value) == value);
+	}
+}
+#endif
+
+#if defined(EGL_CONFIG_FILTER_AVX2)
+__attribute__((target("avx2"))) static void _eglInternalFilterAtLeastAVX2(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	const __m256i v = _mm256_set1_epi32(value);
+
+	for (EGLint i = 0; i < count; i += 8)
+	{
+		__m256i m = _mm256_loadu_si256((const __m256i*)(mask + i));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(column + i));
+
+		// Fails, if value > column.
+		m = _mm256_andnot_si256(_mm256_cmpgt_epi32(v, c), m);
+
+		_mm256_storeu_si256((__m256i*)(mask + i), m);
+	}
+}
+
+__attribute__((target("avx2"))) static void _eglInternalFilterEqualAVX2(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	const __m256i v = _mm256_set1_epi32(value);
+
+	for (EGLint i = 0; i < count; i += 8)
+	{
+		__m256i m = _mm256_loadu_si256((const __m256i*)(mask + i));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(column + i));
+
+		m = _mm256_and_si256(_mm256_cmpeq_epi32(c, v), m);
+
+		_mm256_storeu_si256((__m256i*)(mask + i), m);
+	}
+}
+
+__attribute__((target("avx2"))) static void _eglInternalFilterContainsAVX2(EGLint* mask, const EGLint* column, EGLint value, EGLint count)
+{
+	const __m256i v = _mm256_set1_epi32(value);
+
+	for (EGLint i = 0; i < count; i += 8)
+	{
+		__m256i m = _mm256_loadu_si256((const __m256i*)(mask + i));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(column + i));
+
+		m = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(c, v), v), m);
+
+		_mm256_storeu_si256((__m256i*)(mask + i), m);
+	}
+}
+#endif
+
+static const EGLConfigFilterKernels& _eglInternalGetFilterKernels()
+{
+	static const EGLConfigFilterKernels kernels = []()
+	{
+#if defined(EGL_CONFIG_FILTER_AVX2)
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return EGLConfigFilterKernels{ _eglInternalFilterAtLeastAVX2, _eglInternalFilterEqualAVX2, _eglInternalFilterContainsAVX2 };
+		}
+#endif
+#if defined(EGL_CONFIG_FILTER_SSE2)
+		return EGLConfigFilterKernels{ _eglInternalFilterAtLeastSSE2, _eglInternalFilterEqualSSE2, _eglInternalFilterContainsSSE2 };
+#else
+		return EGLConfigFilterKernels{ _eglInternalFilterAtLeast, _eglInternalFilterEqual, _eglInternalFilterContains };
+#endif
+	}();
+
+	return kernels;
+}
+
+static EGLint _eglInternalConfigColumnValue(const EGLConfigImpl* config, EGLint column)
+{
+	switch (column)
+	{
+		case EGL_CONFIG_COLUMN_ALPHA_MASK_SIZE: return config->alphaMaskSize;
+		case EGL_CONFIG_COLUMN_ALPHA_SIZE: return config->alphaSize;
+		case EGL_CONFIG_COLUMN_BIND_TO_TEXTURE_RGB: return config->bindToTextureRGB;
+		case EGL_CONFIG_COLUMN_BIND_TO_TEXTURE_RGBA: return config->bindToTextureRGBA;
+		case EGL_CONFIG_COLUMN_BLUE_SIZE: return config->blueSize;
+		case EGL_CONFIG_COLUMN_BUFFER_SIZE: return config->bufferSize;
+		case EGL_CONFIG_COLUMN_COLOR_BUFFER_TYPE: return config->colorBufferType;
+		case EGL_CONFIG_COLUMN_CONFIG_CAVEAT: return config->configCaveat;
+		case EGL_CONFIG_COLUMN_CONFIG_ID: return config->configId;
+		case EGL_CONFIG_COLUMN_CONFORMANT: return config->conformant;
+		case EGL_CONFIG_COLUMN_DEPTH_SIZE: return config->depthSize;
+		case EGL_CONFIG_COLUMN_GREEN_SIZE: return config->greenSize;
+		case EGL_CONFIG_COLUMN_LEVEL: return config->level;
+		case EGL_CONFIG_COLUMN_LUMINANCE_SIZE: return config->luminanceSize;
+		case EGL_CONFIG_COLUMN_MATCH_NATIVE_PIXMAP: return config->matchNativePixmap;
+		case EGL_CONFIG_COLUMN_NATIVE_RENDERABLE: return config->nativeRenderable;
+		case EGL_CONFIG_COLUMN_MAX_SWAP_INTERVAL: return config->maxSwapInterval;
+		case EGL_CONFIG_COLUMN_MIN_SWAP_INTERVAL: return config->minSwapInterval;
+		case EGL_CONFIG_COLUMN_RED_SIZE: return config->redSize;
+		case EGL_CONFIG_COLUMN_SAMPLE_BUFFERS: return config->sampleBuffers;
+		case EGL_CONFIG_COLUMN_SAMPLES: return config->samples;
+		case EGL_CONFIG_COLUMN_STENCIL_SIZE: return config->stencilSize;
+		case EGL_CONFIG_COLUMN_RENDERABLE_TYPE: return config->renderableType;
+		case EGL_CONFIG_COLUMN_SURFACE_TYPE: return config->surfaceType;
+		case EGL_CONFIG_COLUMN_TRANSPARENT_TYPE: return config->transparentType;
+		case EGL_CONFIG_COLUMN_TRANSPARENT_RED_VALUE: return config->transparentRedValue;
+		case EGL_CONFIG_COLUMN_TRANSPARENT_GREEN_VALUE: return config->transparentGreenValue;
+		case EGL_CONFIG_COLUMN_TRANSPARENT_BLUE_VALUE: return config->transparentBlueValue;
+		case EGL_CONFIG_COLUMN_DOUBLE_BUFFER: return config->doubleBuffer;
+	}
+
+	return 0;
+}
+
+static EGLBoolean _eglInternalBuildConfigStore(EGLConfigStore* store, const EGLConfigImpl* rootConfig)
+{
+	EGLint count = 0;
+	for (const EGLConfigImpl* walkerConfig = rootConfig; walkerConfig; walkerConfig = walkerConfig->next)
+	{
+		count++;
+	}
+
+	const EGLint paddedCount = (count + EGL_CONFIG_STORE_LANES - 1) / EGL_CONFIG_STORE_LANES * EGL_CONFIG_STORE_LANES;
+
+	try
+	{
+		store->configs.assign(count, 0);
+		store->columns.assign((size_t)paddedCount * EGL_CONFIG_COLUMN_COUNT, 0);
+		store->matchMask.assign(paddedCount, 0);
+		store->matches.assign(count, 0);
+	}
+	catch (const std::bad_alloc&)
+	{
+		_eglInternalClearConfigStore(store);
+
+		return EGL_FALSE;
+	}
+
+	store->count = count;
+	store->paddedCount = paddedCount;
+
+	for (EGLint column = 0; column < EGL_CONFIG_COLUMN_COUNT; column++)
+	{
+		store->columnMin[column] = 0;
+	}
+
+	EGLint index = 0;
+	for (const EGLConfigImpl* walkerConfig = rootConfig; walkerConfig; walkerConfig = walkerConfig->next, index++)
+	{
+		store->configs[index] = (EGLConfigImpl*)walkerConfig;
+
+		for (EGLint column = 0; column < EGL_CONFIG_COLUMN_COUNT; column++)
+		{
+			const EGLint value = _eglInternalConfigColumnValue(walkerConfig, column);
+
+			store->columns[(size_t)column * paddedCount + index] = value;
+
+			if (index == 0 || value < store->columnMin[column])
+			{
+				store->columnMin[column] = value;
+			}
+		}
+	}
+
+	return EGL_TRUE;
+}
+
+//
+// EGL_VERSION_1_0
+//
+
+static int _ChooseConfig_sort_predicate(const void* _lhs, const void* _rhs)
+{
+	const EGLConfigImpl* lhs = *(const EGLConfigImpl**)_lhs;
+	const EGLConfigImpl* rhs = *(const EGLConfigImpl**)_rhs;
+
+	if (lhs->configCaveat == rhs->configCaveat)
+	{
+		if (lhs->colorBufferType == rhs->colorBufferType)
+		{
+			EGLint color_bits[2] = { 0, 0 };
+			switch (lhs->colorBufferType)
+			{
+			case EGL_RGB_BUFFER:
+				color_bits[0] = lhs->redSize + lhs->greenSize + lhs->blueSize + lhs->alphaSize;
+				color_bits[1] = rhs->redSize + rhs->greenSize + rhs->blueSize + rhs->alphaSize;
+				break;
+			case EGL_LUMINANCE_BUFFER:
+				color_bits[0] = lhs->luminanceSize + lhs->alphaSize;
+				color_bits[1] = rhs->luminanceSize + rhs->alphaSize;
+				break;
+			default:
+				break;
+			}
+
+			if (color_bits[0] == color_bits[1])
+			{
+				if (lhs->bufferSize == rhs->bufferSize)
+				{
+					if (lhs->sampleBuffers == rhs->sampleBuffers)
+					{
+						if (lhs->samples == rhs->samples)
+						{
+							if (lhs->depthSize == rhs->depthSize)
+							{
+								if (lhs->stencilSize == rhs->stencilSize)
+								{
+									if (lhs->alphaMaskSize == rhs->alphaMaskSize)
+									{
+										// skip rule 10 since it's impl-defined
+										// 10. Special: EGL_NATIVE_VISUAL_TYPE (the actual sort order is implementation-defined, depending on the meaning of native visual types).
+
+										// 11. Smaller EGL_CONFIG_ID (guarantees a unique ordering)
+										return (lhs->configId - rhs->configId);
+									}
+									else return (lhs->alphaMaskSize - rhs->alphaMaskSize); // 9. Smaller EGL_ALPHA_MASK_SIZE
+								}
+								else return (lhs->stencilSize - rhs->stencilSize); // 8. Smaller EGL_STENCIL_SIZE
+							}
+							else return (lhs->depthSize - rhs->depthSize); // 7. Smaller EGL_DEPTH_SIZE
+						}
+						else return (lhs->samples - rhs->samples); // 6. Smaller EGL_SAMPLES
+					}
+					else return (lhs->sampleBuffers - rhs->sampleBuffers); // 5. Smaller EGL_SAMPLE_BUFFERS
+				}
+				else return (lhs->bufferSize - rhs->bufferSize); // 4. Smaller EGL_BUFFER_SIZE
+			}
+			else return color_bits[1] - color_bits[0]; // 3. by larger total number of color bits
+		}
+		else return (lhs->colorBufferType - rhs->colorBufferType); // 2. by EGL_COLOR_BUFFER_TYPE
+	}
+	else return (lhs->configCaveat - rhs->configCaveat); // 1. by EGL_CONFIG_CAVEAT
+}
+
+EGLBoolean _eglChooseConfig(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig *configs, EGLint config_size, EGLint *num_config)
+{
+	if (!attrib_list)
+	{
+		g_localStorage.error = EGL_BAD_PARAMETER;
+
+		return EGL_FALSE;
+	}
+
+	// Without configs, only the number of matching configurations is returned.
+	if (configs && config_size == 0)
+	{
+		g_localStorage.error = EGL_BAD_PARAMETER;
+
+		return EGL_FALSE;
+	}
+
+	if (!num_config)
+	{
+		g_localStorage.error = EGL_BAD_PARAMETER;
+
+		return EGL_FALSE;
+	}
+
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			guard_t _{ walkerDpy->mutex };
+
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
+
+				return EGL_FALSE;
+			}
+
+			EGLint attribListIndex = 0;
+
+			EGLConfigImpl config;
+
+			_eglInternalSetDefaultConfig(&config);
+			config.configCaveat = EGL_DONT_CARE; // dont care for this attribute since it cant be queried on both WGL and GLX
+
+			while (attrib_list[attribListIndex] != EGL_NONE)
+			{
+				EGLint value = attrib_list[attribListIndex + 1];
+
+				switch (attrib_list[attribListIndex])
+				{
+					case EGL_ALPHA_MASK_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.alphaMaskSize = value;
+					}
+					break;
+					case EGL_ALPHA_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.alphaSize = value;
+					}
+					break;
+					case EGL_BIND_TO_TEXTURE_RGB:
+					{
+						if (value != EGL_DONT_CARE && value != EGL_TRUE && value != EGL_FALSE)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.bindToTextureRGB = value;
+					}
+					break;
+					case EGL_BIND_TO_TEXTURE_RGBA:
+					{
+						if (value != EGL_DONT_CARE && value != EGL_TRUE && value != EGL_FALSE)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.bindToTextureRGBA = value;
+					}
+					break;
+					case EGL_BLUE_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.blueSize = value;
+					}
+					break;
+					case EGL_BUFFER_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.bufferSize = value;
+					}
+					break;
+					case EGL_COLOR_BUFFER_TYPE:
+					{
+						if (value != EGL_DONT_CARE && value != EGL_RGB_BUFFER && value != EGL_LUMINANCE_BUFFER)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.colorBufferType = value;
+					}
+					break;
+					case EGL_CONFIG_CAVEAT:
+					{
+						if (value != EGL_DONT_CARE && value != EGL_NONE && value != EGL_SLOW_CONFIG && value != EGL_NON_CONFORMANT_CONFIG)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.configCaveat = value;
+					}
+					break;
+					case EGL_CONFIG_ID:
+					{
+						config.configId = value;
+					}
+					break;
+					case EGL_CONFORMANT:
+					{
+						if (value != EGL_DONT_CARE && value & ~(EGL_OPENGL_BIT | EGL_OPENGL_ES_BIT | EGL_OPENGL_ES2_BIT | EGL_OPENGL_ES3_BIT | EGL_OPENVG_BIT))
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.conformant = value;
+					}
+					break;
+					case EGL_DEPTH_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.depthSize = value;
+					}
+					break;
+					case EGL_GREEN_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.greenSize = value;
+					}
+					break;
+					case EGL_LEVEL:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.level = value;
+					}
+					break;
+					case EGL_LUMINANCE_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.luminanceSize = value;
+					}
+					break;
+					case EGL_MATCH_NATIVE_PIXMAP:
+					{
+						config.matchNativePixmap = value;
+					}
+					break;
+					case EGL_NATIVE_RENDERABLE:
+					{
+						if (value != EGL_DONT_CARE && value != EGL_TRUE && value != EGL_FALSE)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.nativeRenderable = value;
+					}
+					break;
+					case EGL_MAX_SWAP_INTERVAL:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.maxSwapInterval = value;
+					}
+					break;
+					case EGL_MIN_SWAP_INTERVAL:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.minSwapInterval = value;
+					}
+					break;
+					case EGL_RED_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.redSize = value;
+					}
+					break;
+					case EGL_SAMPLE_BUFFERS:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.sampleBuffers = value;
+					}
+					break;
+					case EGL_SAMPLES:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.samples = value;
+					}
+					break;
+					case EGL_STENCIL_SIZE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.stencilSize = value;
+					}
+					break;
+					case EGL_RENDERABLE_TYPE:
+					{
+						if (value != EGL_DONT_CARE && value & ~(EGL_OPENGL_BIT | EGL_OPENGL_ES_BIT | EGL_OPENGL_ES2_BIT | EGL_OPENGL_ES3_BIT | EGL_OPENVG_BIT))
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.renderableType = value;
+					}
+					break;
+					case EGL_SURFACE_TYPE:
+					{
+						if (value != EGL_DONT_CARE && value & ~(EGL_MULTISAMPLE_RESOLVE_BOX_BIT | EGL_PBUFFER_BIT | EGL_PIXMAP_BIT | EGL_SWAP_BEHAVIOR_PRESERVED_BIT | EGL_VG_ALPHA_FORMAT_PRE_BIT | EGL_VG_COLORSPACE_LINEAR_BIT | EGL_WINDOW_BIT))
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.surfaceType = value;
+					}
+					break;
+					case EGL_TRANSPARENT_TYPE:
+					{
+						if (value != EGL_DONT_CARE && value != EGL_NONE && value != EGL_TRANSPARENT_TYPE)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.transparentType = value;
+					}
+					break;
+					case EGL_TRANSPARENT_RED_VALUE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.transparentRedValue = value;
+					}
+					break;
+					case EGL_TRANSPARENT_GREEN_VALUE:
+					{
+						if (value != EGL_DONT_CARE && value < 0)
+						{
+							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+							return EGL_FALSE;
+						}
+
+						config.transparentGreenValue = value;
+					}
+					break;
+					case EGL_TRANSPARENT_BLUE_VALUE:
+					{
 						if (value != EGL_DONT_CARE && value < 0)
 						{
 							g_localStorage.error = EGL_BAD_ATTRIBUTE;
 
-							return EGL_FALSE;
-						}
+							return EGL_FALSE;
+						}
+
+						config.transparentBlueValue = value;
+					}
+					break;
+					default:
+					{
+						g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+						return EGL_FALSE;
+					}
+					break;
+				}
+
+				attribListIndex += 2;
+
+				// More than 28 entries can not exist.
+				if (attribListIndex >= 28 * 2)
+				{
+					g_localStorage.error = EGL_BAD_ATTRIBUTE;
+
+					return EGL_FALSE;
+				}
+			}
+			config.drawToWindow = (config.surfaceType & EGL_WINDOW_BIT) ? EGL_TRUE : EGL_FALSE;
+			config.drawToPixmap = (config.surfaceType & EGL_PIXMAP_BIT) ? EGL_TRUE : EGL_FALSE;
+			config.drawToPBuffer = (config.surfaceType & EGL_PBUFFER_BIT) ? EGL_TRUE : EGL_FALSE;
+
+			// Every criterion used below, so equal attribute lists in any order share the cached result.
+			const EGLChooseConfigKey key = {
+				config.alphaMaskSize, config.alphaSize, config.bindToTextureRGB, config.bindToTextureRGBA,
+				config.blueSize, config.bufferSize, config.colorBufferType, config.configCaveat,
+				config.configId, config.conformant, config.depthSize, config.greenSize,
+				config.level, config.luminanceSize, config.matchNativePixmap, config.nativeRenderable,
+				config.maxSwapInterval, config.minSwapInterval, config.redSize, config.sampleBuffers,
+				config.samples, config.stencilSize, config.renderableType, config.surfaceType,
+				config.transparentType, config.transparentRedValue, config.transparentGreenValue, config.transparentBlueValue,
+				config.doubleBuffer
+			};
+
+			auto cachedResult = walkerDpy->chooseConfigCache.find(key);
+
+			if (cachedResult != walkerDpy->chooseConfigCache.end())
+			{
+				walkerDpy->chooseConfigCacheHits++;
+
+				const std::vector<EGLConfigImpl*>& cachedConfigs = cachedResult->second;
+
+				if (!configs)
+				{
+					*num_config = (EGLint)cachedConfigs.size();
+
+					return EGL_TRUE;
+				}
+
+				*num_config = (std::min)((EGLint)cachedConfigs.size(), config_size);
+				for (EGLint i = 0; i < *num_config; i++)
+				{
+					configs[i] = cachedConfigs[i]->handle;
+				}
+
+				return EGL_TRUE;
+			}
+
+			walkerDpy->chooseConfigCacheMisses++;
+
+			// Check, if this configuration exists.
+			const EGLConfigFilterKernels& kernels = _eglInternalGetFilterKernels();
+			EGLConfigStore* store = &walkerDpy->configStore;
+			EGLint* matchMask = store->matchMask.data();
+
+			for (EGLint i = 0; i < store->paddedCount; i++)
+			{
+				matchMask[i] = (i < store->count) ? -1 : 0;
+			}
+
+			// Minimum criteria.
+			const EGLint atLeastColumns[] = {
+				EGL_CONFIG_COLUMN_ALPHA_MASK_SIZE, EGL_CONFIG_COLUMN_ALPHA_SIZE, EGL_CONFIG_COLUMN_BLUE_SIZE, EGL_CONFIG_COLUMN_BUFFER_SIZE,
+				EGL_CONFIG_COLUMN_DEPTH_SIZE, EGL_CONFIG_COLUMN_GREEN_SIZE, EGL_CONFIG_COLUMN_LUMINANCE_SIZE, EGL_CONFIG_COLUMN_RED_SIZE,
+				EGL_CONFIG_COLUMN_SAMPLE_BUFFERS, EGL_CONFIG_COLUMN_SAMPLES
+			};
+			for (EGLint column : atLeastColumns)
+			{
+				if (key[column] > store->columnMin[column])
+				{
+					kernels.atLeast(matchMask, &store->columns[(size_t)column * store->paddedCount], key[column], store->paddedCount);
+				}
+			}
+
+			// Exact criteria, unless EGL_DONT_CARE.
+			const EGLint equalColumns[] = {
+				EGL_CONFIG_COLUMN_BIND_TO_TEXTURE_RGB, EGL_CONFIG_COLUMN_BIND_TO_TEXTURE_RGBA, EGL_CONFIG_COLUMN_COLOR_BUFFER_TYPE, EGL_CONFIG_COLUMN_CONFIG_CAVEAT,
+				EGL_CONFIG_COLUMN_CONFIG_ID, EGL_CONFIG_COLUMN_NATIVE_RENDERABLE, EGL_CONFIG_COLUMN_MAX_SWAP_INTERVAL, EGL_CONFIG_COLUMN_MIN_SWAP_INTERVAL,
+				EGL_CONFIG_COLUMN_STENCIL_SIZE, EGL_CONFIG_COLUMN_DOUBLE_BUFFER,
+				EGL_CONFIG_COLUMN_TRANSPARENT_RED_VALUE, EGL_CONFIG_COLUMN_TRANSPARENT_GREEN_VALUE, EGL_CONFIG_COLUMN_TRANSPARENT_BLUE_VALUE
+			};
+			for (EGLint column : equalColumns)
+			{
+				// The transparent values only matter for transparent configurations.
+				if ((column == EGL_CONFIG_COLUMN_TRANSPARENT_RED_VALUE || column == EGL_CONFIG_COLUMN_TRANSPARENT_GREEN_VALUE || column == EGL_CONFIG_COLUMN_TRANSPARENT_BLUE_VALUE) && key[EGL_CONFIG_COLUMN_TRANSPARENT_TYPE] != EGL_TRANSPARENT_RGB)
+				{
+					continue;
+				}
+
+				if (key[column] != EGL_DONT_CARE)
+				{
+					kernels.equal(matchMask, &store->columns[(size_t)column * store->paddedCount], key[column], store->paddedCount);
+				}
+			}
+
+			if (key[EGL_CONFIG_COLUMN_MATCH_NATIVE_PIXMAP] != EGL_NONE)
+			{
+				kernels.equal(matchMask, &store->columns[(size_t)EGL_CONFIG_COLUMN_MATCH_NATIVE_PIXMAP * store->paddedCount], key[EGL_CONFIG_COLUMN_MATCH_NATIVE_PIXMAP], store->paddedCount);
+			}
+
+			// Always exact criteria.
+			kernels.equal(matchMask, &store->columns[(size_t)EGL_CONFIG_COLUMN_LEVEL * store->paddedCount], key[EGL_CONFIG_COLUMN_LEVEL], store->paddedCount);
+			kernels.equal(matchMask, &store->columns[(size_t)EGL_CONFIG_COLUMN_TRANSPARENT_TYPE * store->paddedCount], key[EGL_CONFIG_COLUMN_TRANSPARENT_TYPE], store->paddedCount);
+
+			// Mask criteria.
+			const EGLint containsColumns[] = {
+				EGL_CONFIG_COLUMN_CONFORMANT, EGL_CONFIG_COLUMN_RENDERABLE_TYPE, EGL_CONFIG_COLUMN_SURFACE_TYPE
+			};
+			for (EGLint column : containsColumns)
+			{
+				if (key[column] != 0)
+				{
+					kernels.contains(matchMask, &store->columns[(size_t)column * store->paddedCount], key[column], store->paddedCount);
+				}
+			}
+
+			EGLConfigImpl** matches = store->matches.data();
+
+			EGLint configIndex = 0;
+			for (EGLint i = 0; i < store->count; i++)
+			{
+				if (matchMask[i])
+				{
+					matches[configIndex++] = store->configs[i];
+				}
+			}
+
+			std::sort(matches, matches + configIndex, [](const EGLConfigImpl* lhs, const EGLConfigImpl* rhs)
+			{
+				return _ChooseConfig_sort_predicate(&lhs, &rhs) < 0;
+			});
+
+			try
+			{
+				walkerDpy->chooseConfigCache.emplace(key, std::vector<EGLConfigImpl*>(matches, matches + configIndex));
+			}
+			catch (const std::bad_alloc&)
+			{
+				// Not cached, the result is still valid.
+			}
+
+			if (!configs)
+			{
+				*num_config = configIndex;
+
+				return EGL_TRUE;
+			}
+
+			*num_config = (std::min)(configIndex, config_size);
+			for (EGLint i = 0; i < *num_config; i++)
+			{
+				configs[i] = matches[i]->handle;
+			}
+
+			return EGL_TRUE;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+	
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_FALSE;
+}
+
+// comment this to bring back original code
+#define FIXED_SHARE_CONTEXT
+EGLContext _eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint *attrib_list)
+{
+	if (!attrib_list)
+	{
+		g_localStorage.error = EGL_BAD_PARAMETER;
+
+		return EGL_NO_CONTEXT;
+	}
+
+	if (g_localStorage.api == EGL_NONE)
+	{
+		g_localStorage.error = EGL_BAD_MATCH;
+
+		return EGL_NO_CONTEXT;
+	}
+
+	if (g_localStorage.api != EGL_OPENGL_API && g_localStorage.api != EGL_OPENGL_ES_API)
+	{
+		return EGL_NO_CONTEXT;
+	}
+
+	EGLint requested_version[2]{ 1, 0 };
+	EGLBoolean noError = EGL_FALSE;
+	for (EGLint i = 0; attrib_list[i] != EGL_NONE; i += 2)
+	{
+		switch (attrib_list[i])
+		{
+		case EGL_CONTEXT_MAJOR_VERSION:
+			requested_version[0] = attrib_list[i + 1];
+			break;
+		case EGL_CONTEXT_MINOR_VERSION:
+			requested_version[1] = attrib_list[i + 1];
+			break;
+		case EGL_CONTEXT_OPENGL_NO_ERROR_KHR:
+			noError = attrib_list[i + 1] == EGL_TRUE;
+			break;
+		}
+	}
+
+	// The supported versions depend on the other attributes as well, e.g. the profile and the flags.
+	EGLVersionKey versionKey;
+
+	try
+	{
+		versionKey.push_back((EGLint)g_localStorage.api);
+
+		for (EGLint i = 0; attrib_list[i] != EGL_NONE; i += 2)
+		{
+			if (attrib_list[i] == EGL_CONTEXT_MAJOR_VERSION || attrib_list[i] == EGL_CONTEXT_MINOR_VERSION)
+			{
+				continue;
+			}
+
+			EGLVersionKey::iterator position = versionKey.begin() + 1;
+
+			while (position != versionKey.end() && *position <= attrib_list[i])
+			{
+				position += 2;
+			}
+
+			versionKey.insert(position, { attrib_list[i], attrib_list[i + 1] });
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		g_localStorage.error = EGL_BAD_ALLOC;
+
+		return EGL_NO_CONTEXT;
+	}
+
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			std::unique_lock<std::mutex> dpyLock(walkerDpy->mutex);
+
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
+
+				return EGL_FALSE;
+			}
+
+			EGLConfigImpl* walkerConfig = 0;
+
+			if (config == EGL_NO_CONFIG_KHR)
+			{
+				// EGL_KHR_no_config_context: The version is probed with the first configuration supporting the API.
+				walkerConfig = walkerDpy->rootConfig;
+
+				while (walkerConfig && g_localStorage.api == EGL_OPENGL_ES_API && (walkerConfig->conformant & EGL_OPENGL_ES3_BIT) == 0)
+				{
+					walkerConfig = walkerConfig->next;
+				}
+
+				if (!walkerConfig)
+				{
+					g_localStorage.error = EGL_BAD_MATCH;
+
+					return EGL_NO_CONTEXT;
+				}
+			}
+			else
+			{
+				walkerConfig = walkerDpy->configTable.lookup(config);
+
+				if (!walkerConfig)
+				{
+					g_localStorage.error = EGL_BAD_CONFIG;
+
+					return EGL_NO_CONTEXT;
+				}
+			}
+
+			EGLint target_attrib_list[CONTEXT_ATTRIB_LIST_SIZE];
+
+			if (g_localStorage.api == EGL_OPENGL_ES_API && (walkerConfig->conformant & EGL_OPENGL_ES3_BIT) == 0)
+			{
+				return EGL_FALSE;
+			}
+			if (!__processAttribList(walkerDpy, g_localStorage.api, target_attrib_list, attrib_list, &g_localStorage.error))
+			{
+				return EGL_FALSE;
+			}
+
+			EGLVersionBounds versionBounds{};
+
+			auto knownBounds = walkerDpy->versionBounds.find(versionKey);
+
+			if (knownBounds != walkerDpy->versionBounds.end())
+			{
+				versionBounds = knownBounds->second;
+			}
+
+			EGLBoolean versionSupported;
+
+			if (!_eglInternalKnownVersion(&versionBounds, requested_version[0], requested_version[1], &versionSupported))
+			{
+				// Probing creates native contexts, so the display lock is released meanwhile. The configuration stays,
+				// as configurations are only freed with the display, which the display list lock keeps.
+				dpyLock.unlock();
+
+				{
+					auto dummy = g_globalStorage.dummy_read();
+
+					versionSupported = _eglInternalProbeVersion(walkerDpy, walkerConfig, &dummy, g_localStorage.api, target_attrib_list, &versionBounds, requested_version[0], requested_version[1]);
+				}
+
+				dpyLock.lock();
+
+				try
+				{
+					_eglInternalMergeVersionBounds(&walkerDpy->versionBounds[versionKey], &versionBounds);
+				}
+				catch (const std::bad_alloc&)
+				{
+					// Not remembered, the result is still valid.
+				}
+
+				// The display may have been terminated meanwhile.
+				if (!walkerDpy->initialized || walkerDpy->destroy)
+				{
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return EGL_NO_CONTEXT;
+				}
+
+				if (config != EGL_NO_CONFIG_KHR && walkerDpy->configTable.lookup(config) != walkerConfig)
+				{
+					g_localStorage.error = EGL_BAD_CONFIG;
+
+					return EGL_NO_CONTEXT;
+				}
+			}
+
+			if (!versionSupported)
+			{
+				g_localStorage.error = EGL_BAD_MATCH;
+
+				return EGL_NO_CONTEXT;
+			}
+
+			EGLContextImpl* sharedCtx = 0;
+
+			if (share_context != EGL_NO_CONTEXT)
+			{
+				sharedCtx = walkerDpy->ctxTable.lookup(share_context);
+
+				if (!sharedCtx || !sharedCtx->initialized || sharedCtx->destroy)
+				{
+					g_localStorage.error = EGL_BAD_CONTEXT;
+
+					return EGL_FALSE;
+				}
+
+				if (sharedCtx->noError != noError)
+				{
+					g_localStorage.error = EGL_BAD_MATCH;
+
+					return EGL_FALSE;
+				}
+			}
+
+			EGLContextImpl* newCtx = (EGLContextImpl*)malloc(sizeof(EGLContextImpl));
+
+			if (!newCtx)
+			{
+				g_localStorage.error = EGL_BAD_ALLOC;
+
+				return EGL_FALSE;
+			}
+
+			// A context without shared context starts a share group of its own.
+			EGLShareGroupImpl* shareGroup = sharedCtx ? sharedCtx->shareGroup : new (std::nothrow) EGLShareGroupImpl();
 
-						config.transparentRedValue = value;
-					}
-					break;
-					case EGL_TRANSPARENT_GREEN_VALUE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+			if (!shareGroup)
+			{
+				free(newCtx);
 
-							return EGL_FALSE;
-						}
+				g_localStorage.error = EGL_BAD_ALLOC;
 
-						config.transparentGreenValue = value;
-					}
-					break;
-					case EGL_TRANSPARENT_BLUE_VALUE:
-					{
-						if (value != EGL_DONT_CARE && value < 0)
-						{
-							g_localStorage.error = EGL_BAD_ATTRIBUTE;
+				return EGL_FALSE;
+			}
+
+			newCtx->handle = walkerDpy->ctxTable.insert(newCtx);
+
+			if (!newCtx->handle)
+			{
+				if (!sharedCtx)
+				{
+					delete shareGroup;
+				}
+
+				free(newCtx);
+
+				g_localStorage.error = EGL_BAD_ALLOC;
+
+				return EGL_FALSE;
+			}
+
+			if (!sharedCtx)
+			{
+				shareGroup->api = g_localStorage.api;
+				shareGroup->noError = noError;
+				shareGroup->displayShared = EGL_FALSE;
+			}
+
+			shareGroup->refCount++;
+
+			// Move the atttibutes for later creation.
+			memcpy(newCtx->attribList, target_attrib_list, CONTEXT_ATTRIB_LIST_SIZE * sizeof(EGLint));
+
+			newCtx->initialized = EGL_TRUE;
+			newCtx->destroy = EGL_FALSE;
+			newCtx->configId = config == EGL_NO_CONFIG_KHR ? 0 : walkerConfig->configId;
+			newCtx->sharedCtx = sharedCtx;
+			newCtx->shareGroup = shareGroup;
+			newCtx->noError = noError;
+			newCtx->rootCtxList = 0;
+			newCtx->currentCount = 0;
+			newCtx->pendingCount = 0;
+
+			_eglInternalLink(&walkerDpy->rootCtx, newCtx);
+
+			return newCtx->handle;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_NO_CONTEXT;
+}
+
+EGLSurface _eglCreatePbufferSurface(EGLDisplay dpy, EGLConfig config, const EGLint* attrib_list)
+{
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
+
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			guard_t _{ walkerDpy->mutex };
+
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
+
+				return EGL_NO_SURFACE;
+			}
+
+			EGLConfigImpl* walkerConfig = walkerDpy->configTable.lookup(config);
+
+			if (!walkerConfig)
+			{
+				g_localStorage.error = EGL_BAD_CONFIG;
+
+				return EGL_NO_SURFACE;
+			}
+
+			EGLSurfaceImpl* newSurface = (EGLSurfaceImpl*)malloc(sizeof(EGLSurfaceImpl));
+
+			if (!newSurface)
+			{
+				g_localStorage.error = EGL_BAD_ALLOC;
+
+				return EGL_NO_SURFACE;
+			}
+
+			if (!__createPbufferSurface(newSurface, attrib_list, walkerDpy, walkerConfig, &g_localStorage.error))
+			{
+				free(newSurface);
+
+				return EGL_NO_SURFACE;
+			}
+
+			newSurface->currentCount = 0;
+
+			newSurface->handle = walkerDpy->surfaceTable.insert(newSurface);
+
+			if (!newSurface->handle)
+			{
+				__destroySurface(newSurface);
+
+				free(newSurface);
+
+				g_localStorage.error = EGL_BAD_ALLOC;
+
+				return EGL_NO_SURFACE;
+			}
+
+			_eglInternalLink(&walkerDpy->rootSurface, newSurface);
+
+			return newSurface->handle;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+	
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_NO_SURFACE;
+}
+
+EGLSurface _eglCreateWindowSurface(EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint *attrib_list)
+{
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			guard_t _{ walkerDpy->mutex };
+
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
+
+				return EGL_NO_SURFACE;
+			}
+
+			EGLConfigImpl* walkerConfig = walkerDpy->configTable.lookup(config);
+
+			if (!walkerConfig)
+			{
+				g_localStorage.error = EGL_BAD_CONFIG;
+
+				return EGL_NO_SURFACE;
+			}
+
+			EGLSurfaceImpl* newSurface = (EGLSurfaceImpl*)malloc(sizeof(EGLSurfaceImpl));
+
+			if (!newSurface)
+			{
+				g_localStorage.error = EGL_BAD_ALLOC;
+
+				return EGL_NO_SURFACE;
+			}
+
+			if (!__createWindowSurface(newSurface, win, attrib_list, walkerDpy, walkerConfig, &g_localStorage.error))
+			{
+				free(newSurface);
+
+				return EGL_NO_SURFACE;
+			}
+
+			newSurface->currentCount = 0;
+
+			newSurface->handle = walkerDpy->surfaceTable.insert(newSurface);
+
+			if (!newSurface->handle)
+			{
+				__destroySurface(newSurface);
+
+				free(newSurface);
+
+				g_localStorage.error = EGL_BAD_ALLOC;
+
+				return EGL_NO_SURFACE;
+			}
+
+			_eglInternalLink(&walkerDpy->rootSurface, newSurface);
+
+			return newSurface->handle;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+	
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_NO_SURFACE;
+}
+
+EGLBoolean _eglDestroyContext(EGLDisplay dpy, EGLContext ctx)
+{
+	EGLBoolean success = EGL_FALSE;
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
+			{
+				guard_t _{ walkerDpy->mutex };
+
+				if (!walkerDpy->initialized || walkerDpy->destroy)
+				{
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return EGL_FALSE;
+				}
+
+				EGLContextImpl* walkerCtx = walkerDpy->ctxTable.lookup(ctx);
+
+				if (!walkerCtx || !walkerCtx->initialized || walkerCtx->destroy)
+				{
+					g_localStorage.error = EGL_BAD_CONTEXT;
+
+					return EGL_FALSE;
+				}
+
+				walkerCtx->initialized = EGL_FALSE;
+				walkerCtx->destroy.store(EGL_TRUE, std::memory_order_release);
+
+				_eglInternalRetire(&walkerDpy->rootCtx, &walkerDpy->retiredCtxs, walkerCtx);
+
+				success = EGL_TRUE;
+				break;
+			}
+
+			walkerDpy = walkerDpy->next;
+		}
+	}
+	
+	if (success)
+	{
+		_eglInternalCleanup();
+
+		return EGL_TRUE;
+	}
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_FALSE;
+}
+
+EGLBoolean _eglDestroySurface(EGLDisplay dpy, EGLSurface surface)
+{
+	EGLBoolean success = EGL_FALSE;
+
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
+			{
+				guard_t _{ walkerDpy->mutex };
+
+				if (!walkerDpy->initialized || walkerDpy->destroy)
+				{
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return EGL_FALSE;
+				}
+
+				EGLSurfaceImpl* walkerSurface = walkerDpy->surfaceTable.lookup(surface);
+
+				if (!walkerSurface || !walkerSurface->initialized || walkerSurface->destroy)
+				{
+					g_localStorage.error = EGL_BAD_SURFACE;
+
+					return EGL_FALSE;
+				}
+
+				// The native surface is destroyed by cleanup, as other threads may still use it.
+				walkerSurface->initialized = EGL_FALSE;
+				walkerSurface->destroy.store(EGL_TRUE, std::memory_order_release);
+
+				_eglInternalRetire(&walkerDpy->rootSurface, &walkerDpy->retiredSurfaces, walkerSurface);
+
+				success = EGL_TRUE;
+				break;
+			}
+
+			walkerDpy = walkerDpy->next;
+		}
+	}
+
+	if (success)
+	{
+		_eglInternalCleanup();
 
-							return EGL_FALSE;
-						}
+		return EGL_TRUE;
+	}
 
-						config.transparentBlueValue = value;
-					}
-					break;
-					default:
-					{
-						g_localStorage.error = EGL_BAD_ATTRIBUTE;
+	g_localStorage.error = EGL_BAD_DISPLAY;
 
-						return EGL_FALSE;
-					}
-					break;
-				}
+	return EGL_FALSE;
+}
 
-				attribListIndex += 2;
+EGLBoolean _eglGetConfigAttrib(EGLDisplay dpy, EGLConfig config, EGLint attribute, EGLint *value)
+{
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
 
-				// More than 28 entries can not exist.
-				if (attribListIndex >= 28 * 2)
-				{
-					g_localStorage.error = EGL_BAD_ATTRIBUTE;
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
-					return EGL_FALSE;
-				}
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			guard_t _{ walkerDpy->mutex };
+
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
+
+				return EGL_FALSE;
 			}
-			config.drawToWindow = (config.surfaceType & EGL_WINDOW_BIT) ? EGL_TRUE : EGL_FALSE;
-			config.drawToPixmap = (config.surfaceType & EGL_PIXMAP_BIT) ? EGL_TRUE : EGL_FALSE;
-			config.drawToPBuffer = (config.surfaceType & EGL_PBUFFER_BIT) ? EGL_TRUE : EGL_FALSE;
 
-			// Check, if this configuration exists.
-			EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+			EGLConfigImpl* walkerConfig = walkerDpy->configTable.lookup(config);
 
-			#define stack_mem_sz (1ull << 13) // 8k
-			char stack_mem[stack_mem_sz];
-			const EGLint max_configs = stack_mem_sz / sizeof(EGLConfig);
-			EGLConfig* configsOnStack = (EGLConfig*)stack_mem;
+			if (!walkerConfig)
+			{
+				g_localStorage.error = EGL_BAD_CONFIG;
 
-			EGLint configIndex = 0;
+				return EGL_FALSE;
+			}
 
-			int itercount = 0;
-			while (walkerConfig && configIndex < max_configs)
+			switch (attribute)
 			{
-				++itercount;
-				if (config.alphaMaskSize > walkerConfig->alphaMaskSize)
+				case EGL_ALPHA_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->alphaSize;
+					}
 				}
-				if (config.alphaSize > walkerConfig->alphaSize)
+				break;
+				case EGL_ALPHA_MASK_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->alphaMaskSize;
+					}
 				}
-				if (config.bindToTextureRGB != EGL_DONT_CARE && config.bindToTextureRGB != walkerConfig->bindToTextureRGB)
+				break;
+				case EGL_BIND_TO_TEXTURE_RGB:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->bindToTextureRGB;
+					}
 				}
-				if (config.bindToTextureRGBA != EGL_DONT_CARE && config.bindToTextureRGBA != walkerConfig->bindToTextureRGBA)
+				break;
+				case EGL_BIND_TO_TEXTURE_RGBA:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->bindToTextureRGBA;
+					}
 				}
-				if (config.blueSize > walkerConfig->blueSize)
+				break;
+				case EGL_BLUE_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->blueSize;
+					}
 				}
-				if (config.bufferSize > walkerConfig->bufferSize)
+				break;
+				case EGL_BUFFER_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->bufferSize;
+					}
 				}
-				if (config.colorBufferType != EGL_DONT_CARE && config.colorBufferType != walkerConfig->colorBufferType)
+				break;
+				case EGL_COLOR_BUFFER_TYPE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->colorBufferType;
+					}
 				}
-				if (config.configCaveat != EGL_DONT_CARE && config.configCaveat != walkerConfig->configCaveat)
+				break;
+				case EGL_CONFIG_CAVEAT:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->configCaveat;
+					}
 				}
-				if (config.configId != EGL_DONT_CARE && config.configId != walkerConfig->configId)
+				break;
+				case EGL_CONFIG_ID:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->configId;
+					}
 				}
-				if ((config.conformant & walkerConfig->conformant) != config.conformant)
+				break;
+				case EGL_CONFORMANT:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->conformant;
+					}
 				}
-				if (config.depthSize > walkerConfig->depthSize)
+				break;
+				case EGL_DEPTH_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->depthSize;
+					}
 				}
-				if (config.greenSize > walkerConfig->greenSize)
+				break;
+				case EGL_GREEN_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->greenSize;
+					}
 				}
-				if (config.level != walkerConfig->level)
+				break;
+				case EGL_LEVEL:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->level;
+					}
 				}
-				if (config.luminanceSize > walkerConfig->luminanceSize)
+				break;
+				case EGL_LUMINANCE_SIZE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->luminanceSize;
+					}
 				}
-				if (config.matchNativePixmap != EGL_NONE && config.matchNativePixmap != walkerConfig->matchNativePixmap)
+				break;
+				case EGL_MAX_PBUFFER_WIDTH:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->maxPBufferWidth;
+					}
 				}
-				if (config.nativeRenderable != EGL_DONT_CARE && config.nativeRenderable != walkerConfig->nativeRenderable)
+				break;
+				case EGL_MAX_PBUFFER_HEIGHT:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->maxPBufferHeight;
+					}
 				}
-				if (config.maxSwapInterval != EGL_DONT_CARE && config.maxSwapInterval != walkerConfig->maxSwapInterval)
+				break;
+				case EGL_MAX_PBUFFER_PIXELS:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->maxPBufferPixels;
+					}
 				}
-				if (config.minSwapInterval != EGL_DONT_CARE && config.minSwapInterval != walkerConfig->minSwapInterval)
+				break;
+				case EGL_MAX_SWAP_INTERVAL:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->maxSwapInterval;
+					}
 				}
-				if (config.redSize > walkerConfig->redSize)
+				break;
+				case EGL_MIN_SWAP_INTERVAL:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->minSwapInterval;
+					}
 				}
-				if (config.sampleBuffers > walkerConfig->sampleBuffers)
+				break;
+				case EGL_NATIVE_RENDERABLE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->nativeRenderable;
+					}
 				}
-				if (config.samples > walkerConfig->samples)
+				break;
+				case EGL_NATIVE_VISUAL_ID:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->nativeVisualId;
+					}
 				}
-				if ((config.stencilSize != EGL_DONT_CARE) && (config.stencilSize != walkerConfig->stencilSize))
+				break;
+				case EGL_NATIVE_VISUAL_TYPE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->nativeVisualType;
+					}
+				}
+				break;
+				case EGL_RED_SIZE:
+				{
+					if (value)
+					{
+						*value = walkerConfig->redSize;
+					}
 				}
-				if ((config.renderableType & walkerConfig->renderableType) != config.renderableType)
+				break;
+				case EGL_RENDERABLE_TYPE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->renderableType;
+					}
 				}
-				if ((config.surfaceType & walkerConfig->surfaceType) != config.surfaceType)
+				break;
+				case EGL_SAMPLE_BUFFERS:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->sampleBuffers;
+					}
 				}
-				if (config.transparentType != walkerConfig->transparentType)
+				break;
+				case EGL_SAMPLES:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->samples;
+					}
 				}
-				if (walkerConfig->transparentType == EGL_TRANSPARENT_RGB)
+				break;
+				case EGL_STENCIL_SIZE:
 				{
-					if (config.transparentRedValue != EGL_DONT_CARE && config.transparentRedValue != walkerConfig->transparentRedValue)
+					if (value)
 					{
-						walkerConfig = walkerConfig->next;
-
-						continue;
+						*value = walkerConfig->stencilSize;
 					}
-					if (config.transparentGreenValue != EGL_DONT_CARE && config.transparentGreenValue != walkerConfig->transparentGreenValue)
+				}
+				break;
+				case EGL_SURFACE_TYPE:
+				{
+					if (value)
 					{
-						walkerConfig = walkerConfig->next;
-
-						continue;
+						*value = walkerConfig->surfaceType;
 					}
-					if (config.transparentBlueValue != EGL_DONT_CARE && config.transparentBlueValue != walkerConfig->transparentBlueValue)
+				}
+				break;
+				case EGL_TRANSPARENT_TYPE:
+				{
+					if (value)
 					{
-						walkerConfig = walkerConfig->next;
-
-						continue;
+						*value = walkerConfig->transparentType;
 					}
 				}
-
-				//
-				/*
-				if (config.drawToWindow != walkerConfig->drawToWindow)
+				break;
+				case EGL_TRANSPARENT_RED_VALUE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->transparentRedValue;
+					}
 				}
-
-				if (config.drawToPixmap != walkerConfig->drawToPixmap)
+				break;
+				case EGL_TRANSPARENT_GREEN_VALUE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->transparentGreenValue;
+					}
 				}
-
-				if (config.drawToPBuffer != walkerConfig->drawToPBuffer)
+				break;
+				case EGL_TRANSPARENT_BLUE_VALUE:
 				{
-					walkerConfig = walkerConfig->next;
-
-					continue;
+					if (value)
+					{
+						*value = walkerConfig->transparentBlueValue;
+					}
 				}
-				*/
-
-				if (config.doubleBuffer != EGL_DONT_CARE && config.doubleBuffer != walkerConfig->doubleBuffer)
+				break;
+				default:
 				{
-					walkerConfig = walkerConfig->next;
+					g_localStorage.error = EGL_BAD_ATTRIBUTE;
 
-					continue;
+					return EGL_FALSE;
 				}
-
-				//
-
-				configsOnStack[configIndex] = walkerConfig;
-
-				walkerConfig = walkerConfig->next;
-
-				configIndex++;
+				break;
 			}
 
-			if (configIndex)
-				qsort(configsOnStack, configIndex, sizeof(*configs), &_ChooseConfig_sort_predicate);
-
-			*num_config = (std::min)(configIndex, config_size);
-			memcpy(configs, configsOnStack, *num_config*sizeof(EGLConfig));
-
 			return EGL_TRUE;
 		}
 
 		walkerDpy = walkerDpy->next;
 	}
+
 	
 
 	g_localStorage.error = EGL_BAD_DISPLAY;
@@ -1164,54 +3046,23 @@ EGLBoolean _eglChooseConfig(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig
 	return EGL_FALSE;
 }
 
-// comment this to bring back original code
-#define FIXED_SHARE_CONTEXT
-EGLContext _eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint *attrib_list)
+EGLBoolean _eglGetConfigs(EGLDisplay dpy, EGLConfig *configs, EGLint config_size, EGLint *num_config)
 {
-	if (!attrib_list)
+	// Without configs, only the number of configurations is returned.
+	if (configs && config_size == 0)
 	{
 		g_localStorage.error = EGL_BAD_PARAMETER;
 
-		return EGL_NO_CONTEXT;
-	}
-
-	if (g_localStorage.api == EGL_NONE)
-	{
-		g_localStorage.error = EGL_BAD_MATCH;
-
-		return EGL_NO_CONTEXT;
+		return EGL_FALSE;
 	}
 
-	EGLint requested_version[2]{ 1, 0 };
-	for (EGLint i = 0; attrib_list[i] != EGL_NONE; i += 2)
+	if (!num_config)
 	{
-		switch (attrib_list[i])
-		{
-		case EGL_CONTEXT_MAJOR_VERSION:
-			requested_version[0] = attrib_list[i + 1];
-			break;
-		case EGL_CONTEXT_MINOR_VERSION:
-			requested_version[1] = attrib_list[i + 1];
-			break;
-		}
-	}
+		g_localStorage.error = EGL_BAD_PARAMETER;
 
-	if (g_localStorage.api == EGL_OPENGL_API)
-	{
-		if (requested_version[0] > g_GL_max_supported_version[0] || requested_version[1] > g_GL_max_supported_version[1])
-			return EGL_NO_CONTEXT;
-	}
-	else if (g_localStorage.api == EGL_OPENGL_ES_API)
-	{
-		if (requested_version[0] > g_ES_max_supported_version[0] || requested_version[1] > g_ES_max_supported_version[1])
-			return EGL_NO_CONTEXT;
-	}
-	else
-	{
-		return EGL_NO_CONTEXT;
+		return EGL_FALSE;
 	}
 
-
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
@@ -1228,107 +3079,159 @@ EGLContext _eglCreateContext(EGLDisplay dpy, EGLConfig config, EGLContext share_
 				return EGL_FALSE;
 			}
 
+			if (!configs)
+			{
+				*num_config = walkerDpy->configStore.count;
+
+				return EGL_TRUE;
+			}
+
 			EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
 
-			while (walkerConfig)
+			EGLint configIndex = 0;
+
+			while (walkerConfig && configIndex < config_size)
 			{
-				if ((EGLConfig)walkerConfig == config)
-				{
-					EGLint target_attrib_list[CONTEXT_ATTRIB_LIST_SIZE];
+				configs[configIndex] = walkerConfig->handle;
 
-					if (g_localStorage.api == EGL_OPENGL_ES_API && (walkerConfig->conformant & EGL_OPENGL_ES3_BIT) == 0)
-					{
-						return EGL_FALSE;
-					}
-					if (!__processAttribList(g_localStorage.api, target_attrib_list, attrib_list, &g_localStorage.error))
-					{
-						return EGL_FALSE;
-					}
+				walkerConfig = walkerConfig->next;
 
-					EGLContextImpl* sharedCtx = 0;
+				configIndex++;
+			}
 
-					if (share_context != EGL_NO_CONTEXT)
-					{
-						EGLDisplayImpl* sharedWalkerDpy = g_globalStorage.rootDpy;
+			*num_config = configIndex;
 
-						while (sharedWalkerDpy)
-						{
-							EGLContextImpl* sharedWalkerCtx = sharedWalkerDpy->rootCtx;
+			return EGL_TRUE;
+		}
 
-							while (sharedWalkerCtx)
-							{
-								if ((EGLContext)sharedWalkerCtx == share_context)
-								{
-									if (!sharedWalkerCtx->initialized || sharedWalkerCtx->destroy)
-									{
-										g_localStorage.error = EGL_BAD_CONTEXT;
+		walkerDpy = walkerDpy->next;
+	}
 
-										return EGL_FALSE;
-									}
+	g_localStorage.error = EGL_BAD_DISPLAY;
 
-									sharedCtx = sharedWalkerCtx;
+	return EGL_FALSE;
+}
 
-									break;
-								}
+EGLDisplay _eglGetCurrentDisplay(void)
+{
+	if (g_localStorage.currentCtx == EGL_NO_CONTEXT)
+	{
+		return EGL_NO_DISPLAY;
+	}
 
-								sharedWalkerCtx = sharedWalkerCtx->next;
-							}
+	return (EGLDisplay)g_localStorage.currentDpy;
+}
 
-							sharedWalkerDpy = sharedWalkerDpy->next;
-						}
+EGLSurface _eglGetCurrentSurface(EGLint readdraw)
+{
+	if (g_localStorage.currentCtx == EGL_NO_CONTEXT)
+	{
+		return EGL_NO_SURFACE;
+	}
 
-						if (!sharedCtx)
-						{
-							g_localStorage.error = EGL_BAD_CONTEXT;
+	if (readdraw == EGL_DRAW)
+	{
+		return g_localStorage.currentDraw ? g_localStorage.currentDraw->handle : EGL_NO_SURFACE;
+	}
+	else if (readdraw == EGL_READ)
+	{
+		return g_localStorage.currentRead ? g_localStorage.currentRead->handle : EGL_NO_SURFACE;
+	}
 
-							return EGL_FALSE;
-						}
-					}
+	return EGL_NO_SURFACE;
+}
 
-					EGLContextImpl* newCtx = (EGLContextImpl*)malloc(sizeof(EGLContextImpl));
+EGLDisplay _eglGetDisplay(EGLNativeDisplayType display_id)
+{
+	if (!_eglInternalInit())
+	{
+		return EGL_NO_DISPLAY;
+	}
 
-					if (!newCtx)
-					{
-						g_localStorage.error = EGL_BAD_ALLOC;
+	//
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
 
-						return EGL_FALSE;
-					}
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
-					// Move the atttibutes for later creation.
-					memcpy(newCtx->attribList, target_attrib_list, CONTEXT_ATTRIB_LIST_SIZE * sizeof(EGLint));
+		while (walkerDpy)
+		{
+			if (walkerDpy->display_id == display_id)
+			{
+				return (EGLDisplay)walkerDpy;
+			}
 
-					newCtx->initialized = EGL_TRUE;
-					newCtx->destroy = EGL_FALSE;
-					newCtx->configId = walkerConfig->configId;
-					newCtx->sharedCtx = sharedCtx;
-					newCtx->rootCtxList = 0;
+			walkerDpy = walkerDpy->next;
+		}
+	}
 
-					newCtx->next = walkerDpy->rootCtx;
-					walkerDpy->rootCtx = newCtx;
+	EGLDisplayImpl* newDpy = new EGLDisplayImpl();
 
-					return (EGLContext)newCtx;
-				}
+	if (!newDpy)
+	{
+		return EGL_NO_DISPLAY;
+	}
 
-				walkerConfig = walkerConfig->next;
-			}
+	newDpy->initialized = EGL_FALSE;
+	newDpy->destroy = EGL_FALSE;
+#if defined(_WIN32) || defined(_WIN64)
+	newDpy->display_id = display_id ? display_id : g_globalStorage.dummy_read().hdc;
+#elif defined(__ANDROID__) || defined(ANDROID) || defined(WL_EGL_PLATFORM)
+	newDpy->display_id = 0;
+#else
+	newDpy->display_id = display_id ? display_id : g_globalStorage.dummy_read().display;
+#endif
+	newDpy->rootSurface = 0;
+	newDpy->rootCtx = 0;
+	newDpy->rootConfig = 0;
+	newDpy->rootSync = 0;
+	newDpy->rootImage = 0;
+	newDpy->chooseConfigCacheHits = 0;
+	newDpy->chooseConfigCacheMisses = 0;
+	newDpy->makeCurrentElided = 0;
+	newDpy->contextFlushControl = EGL_FALSE;
+	newDpy->contextNoError = EGL_FALSE;
+	newDpy->currentCount = 0;
 
-			g_localStorage.error = EGL_BAD_CONFIG;
+	auto _wl = g_globalStorage.placeRootDpy_writelock();
+
+	// Another thread may have added the same display in the meantime.
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+	while (walkerDpy)
+	{
+		if (walkerDpy->display_id == newDpy->display_id)
+		{
+			delete newDpy;
+
+			return (EGLDisplay)walkerDpy;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+
+	newDpy->next = g_globalStorage.rootDpy.load();
+	g_globalStorage.rootDpy = newDpy;
+
+	return newDpy;
+}
 
-			return EGL_NO_CONTEXT;
-		}
+EGLint _eglGetError(void)
+{
+	EGLint currentError = g_localStorage.error;
 
-		walkerDpy = walkerDpy->next;
-	}
+	g_localStorage.error = EGL_SUCCESS;
 
-	g_localStorage.error = EGL_BAD_DISPLAY;
+	return currentError;
+}
 
-	return EGL_NO_CONTEXT;
+__eglMustCastToProperFunctionPointerType _eglGetProcAddress(const char *procname)
+{
+	return __getProcAddress(procname);
 }
 
-EGLSurface _eglCreatePbufferSurface(EGLDisplay dpy, EGLConfig config, const EGLint* attrib_list)
+EGLBoolean _eglInitialize(EGLDisplay dpy, EGLint *major, EGLint *minor)
 {
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
-
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
 	while (walkerDpy)
@@ -1337,252 +3240,493 @@ EGLSurface _eglCreatePbufferSurface(EGLDisplay dpy, EGLConfig config, const EGLi
 		{
 			guard_t _{ walkerDpy->mutex };
 
-			if (!walkerDpy->initialized || walkerDpy->destroy)
+			if (walkerDpy->destroy)
 			{
 				g_localStorage.error = EGL_NOT_INITIALIZED;
 
-				return EGL_NO_SURFACE;
+				return EGL_FALSE;
 			}
 
-			EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+			{
+				auto dummy = g_globalStorage.dummy_read();
+				EGLBoolean fail = (!walkerDpy->initialized && !__initialize(walkerDpy, &dummy, &g_localStorage.error));
+				g_globalStorage.dummy_write(dummy);
+				if (fail)
+				{
+					return EGL_FALSE;
+				}
+			}
 
-			while (walkerConfig)
+			if (!walkerDpy->initialized)
 			{
-				if ((EGLConfig)walkerConfig == config)
+				EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+
+				while (walkerConfig)
 				{
-					EGLSurfaceImpl* newSurface = (EGLSurfaceImpl*)malloc(sizeof(EGLSurfaceImpl));
+					walkerConfig->handle = walkerDpy->configTable.insert(walkerConfig);
 
-					if (!newSurface)
+					if (!walkerConfig->handle)
 					{
+						walkerDpy->configTable.clear();
+
 						g_localStorage.error = EGL_BAD_ALLOC;
 
-						return EGL_NO_SURFACE;
+						return EGL_FALSE;
+					}
+
+					walkerConfig = walkerConfig->next;
+				}
+
+				if (!_eglInternalBuildConfigStore(&walkerDpy->configStore, walkerDpy->rootConfig))
+				{
+					walkerDpy->configTable.clear();
+
+					g_localStorage.error = EGL_BAD_ALLOC;
+
+					return EGL_FALSE;
+				}
+
+				walkerDpy->extensions.clear();
+
+				for (size_t i = 0; i < sizeof(g_extensions) / sizeof(g_extensions[0]); i++)
+				{
+					const EGLBoolean supported = !g_extensions[i].native || __hasExtension(walkerDpy, g_extensions[i].name);
+
+					if (g_extensions[i].supported)
+					{
+						walkerDpy->*g_extensions[i].supported = supported;
 					}
 
-					if (!__createPbufferSurface(newSurface, attrib_list, walkerDpy, walkerConfig, &g_localStorage.error))
+					if (!supported)
 					{
-						free(newSurface);
+						continue;
+					}
 
-						return EGL_NO_SURFACE;
+					if (!walkerDpy->extensions.empty())
+					{
+						walkerDpy->extensions += ' ';
 					}
+					walkerDpy->extensions += g_extensions[i].name;
+				}
+			}
 
-					newSurface->next = walkerDpy->rootSurface;
+			walkerDpy->initialized.store(EGL_TRUE, std::memory_order_release);
 
-					walkerDpy->rootSurface = newSurface;
 
-					return (EGLSurface)newSurface;
-				}
+			//
 
-				walkerConfig = walkerConfig->next;
+			if (major)
+			{
+				*major = 1;
 			}
 
-			g_localStorage.error = EGL_BAD_CONFIG;
+			if (minor)
+			{
+				*minor = 5;
+			}
 
-			return EGL_NO_SURFACE;
+			return EGL_TRUE;
 		}
 
 		walkerDpy = walkerDpy->next;
 	}
-	
 
 	g_localStorage.error = EGL_BAD_DISPLAY;
 
-	return EGL_NO_SURFACE;
+	return EGL_FALSE;
 }
 
-EGLSurface _eglCreateWindowSurface(EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint *attrib_list)
+// Surface of the current binding matches the requested one.
+static EGLBoolean _eglInternalIsBoundSurface(const EGLSurfaceImpl* walkerSurface, EGLSurface surface)
 {
-	auto _rl = g_globalStorage.placeRootDpy_readlock();
-	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+	if (walkerSurface == EGL_NO_SURFACE_IMPL)
+	{
+		return surface == EGL_NO_SURFACE;
+	}
 
-	while (walkerDpy)
+	return walkerSurface->handle == surface && !walkerSurface->destroy.load(std::memory_order_acquire);
+}
+
+EGLBoolean _eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx)
+{
+	// Rebinding the current binding of the thread changes nothing. Its objects are pinned by the binding, so they can
+	// be checked without any lock. An object destroyed meanwhile takes the full path, which reports the error.
+	if (g_localStorage.currentCtx != EGL_NO_CONTEXT && ctx != EGL_NO_CONTEXT)
 	{
-		if ((EGLDisplay)walkerDpy == dpy)
+		EGLDisplayImpl* boundDpy = g_localStorage.currentDpy;
+		const EGLContextImpl* boundCtx = g_localStorage.currentCtx;
+
+		if ((EGLDisplay)boundDpy == dpy && boundDpy->initialized.load(std::memory_order_acquire) && !boundDpy->destroy.load(std::memory_order_acquire) &&
+			boundCtx->handle == ctx && !boundCtx->destroy.load(std::memory_order_acquire) &&
+			_eglInternalIsBoundSurface(g_localStorage.currentDraw, draw) && _eglInternalIsBoundSurface(g_localStorage.currentRead, read))
 		{
-			guard_t _{ walkerDpy->mutex };
+			boundDpy->makeCurrentElided.fetch_add(1, std::memory_order_relaxed);
 
-			if (!walkerDpy->initialized || walkerDpy->destroy)
-			{
-				g_localStorage.error = EGL_NOT_INITIALIZED;
+			return EGL_TRUE;
+		}
+	}
 
-				return EGL_NO_SURFACE;
-			}
+	EGLDisplayImpl* currentDpy = 0;
 
-			EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+	EGLSurfaceImpl* currentDraw = EGL_NO_SURFACE_IMPL;
+	EGLSurfaceImpl* currentRead = EGL_NO_SURFACE_IMPL;
+	EGLContextImpl* currentCtx = EGL_NO_CONTEXT_IMPL;
+
+	NativeSurfaceContainer* nativeSurfaceContainer = 0;
+	NativeSurfaceContainer* readSurfaceContainer = 0;
+	NativeContextContainer* nativeContextContainer = 0;
+
+	NativeSurfaceContainer surfacelessSurfaceContainer;
+
+	// Set, if the display share context could not be created. The native context then shares with none.
+	bool noShareCtx = false;
+
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+		// A context without surfaces is allowed by EGL_KHR_surfaceless_context, but not with only one of them.
+		if ((ctx == EGL_NO_CONTEXT && (draw != EGL_NO_SURFACE || read != EGL_NO_SURFACE)) || (ctx != EGL_NO_CONTEXT && (draw == EGL_NO_SURFACE) != (read == EGL_NO_SURFACE)))
+		{
+			g_localStorage.error = EGL_BAD_MATCH;
+
+			return EGL_FALSE;
+		}
 
-			while (walkerConfig)
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
 			{
-				if ((EGLConfig)walkerConfig == config)
+				std::unique_lock<std::mutex> dpyLock(walkerDpy->mutex);
+
+				if (!walkerDpy->initialized || walkerDpy->destroy)
+				{
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return EGL_FALSE;
+				}
+
+				EGLBoolean result;
+
+				if (draw != EGL_NO_SURFACE)
 				{
-					EGLSurfaceImpl* newSurface = (EGLSurfaceImpl*)malloc(sizeof(EGLSurfaceImpl));
+					EGLSurfaceImpl* walkerSurface = walkerDpy->surfaceTable.lookup(draw);
 
-					if (!newSurface)
+					if (!walkerSurface)
 					{
-						g_localStorage.error = EGL_BAD_ALLOC;
+						g_localStorage.error = EGL_BAD_SURFACE;
 
-						return EGL_NO_SURFACE;
+						return EGL_FALSE;
+					}
+
+					if (!walkerSurface->initialized || walkerSurface->destroy)
+					{
+						g_localStorage.error = EGL_BAD_NATIVE_WINDOW;
+
+						return EGL_FALSE;
 					}
 
-					if (!__createWindowSurface(newSurface, win, attrib_list, walkerDpy, walkerConfig, &g_localStorage.error))
+					currentDraw = walkerSurface;
+				}
+
+				if (read != EGL_NO_SURFACE)
+				{
+					EGLSurfaceImpl* walkerSurface = walkerDpy->surfaceTable.lookup(read);
+
+					if (!walkerSurface)
 					{
-						free(newSurface);
+						g_localStorage.error = EGL_BAD_SURFACE;
 
-						return EGL_NO_SURFACE;
+						return EGL_FALSE;
 					}
 
-					newSurface->next = walkerDpy->rootSurface;
+					if (!walkerSurface->initialized || walkerSurface->destroy)
+					{
+						g_localStorage.error = EGL_BAD_NATIVE_WINDOW;
 
-					walkerDpy->rootSurface = newSurface;
+						return EGL_FALSE;
+					}
 
-					return (EGLSurface)newSurface;
+					currentRead = walkerSurface;
 				}
 
-				walkerConfig = walkerConfig->next;
-			}
+				if (ctx != EGL_NO_CONTEXT)
+				{
+					EGLContextImpl* walkerCtx = walkerDpy->ctxTable.lookup(ctx);
 
-			g_localStorage.error = EGL_BAD_CONFIG;
+					if (!walkerCtx || !walkerCtx->initialized || walkerCtx->destroy)
+					{
+						g_localStorage.error = EGL_BAD_CONTEXT;
 
-			return EGL_NO_SURFACE;
-		}
+						return EGL_FALSE;
+					}
 
-		walkerDpy = walkerDpy->next;
-	}
-	
+					// Current to another thread.
+					if (walkerCtx->currentCount > 0 && walkerCtx != g_localStorage.currentCtx)
+					{
+						g_localStorage.error = EGL_BAD_ACCESS;
 
-	g_localStorage.error = EGL_BAD_DISPLAY;
+						return EGL_FALSE;
+					}
 
-	return EGL_NO_SURFACE;
-}
+					currentCtx = walkerCtx;
+				}
 
-EGLBoolean _eglDestroyContext(EGLDisplay dpy, EGLContext ctx)
-{
-	EGLBoolean success = EGL_FALSE;
-	{
-		auto _rl = g_globalStorage.placeRootDpy_readlock();
-		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+				EGLint surfaceConfigId = 0;
 
-		while (walkerDpy)
-		{
-			if ((EGLDisplay)walkerDpy == dpy)
-			{
-				guard_t _{ walkerDpy->mutex };
+				if (currentDraw != EGL_NO_SURFACE)
+				{
+					nativeSurfaceContainer = &currentDraw->nativeSurfaceContainer;
 
-				if (!walkerDpy->initialized || walkerDpy->destroy)
+					surfaceConfigId = currentDraw->configId;
+				}
+				else if (currentCtx != EGL_NO_CONTEXT)
 				{
-					g_localStorage.error = EGL_NOT_INITIALIZED;
+					// No drawable, but a configuration, in case a native context has to be created. A context without
+					// configuration uses the first one of the display.
+					const EGLConfigImpl* walkerConfig = currentCtx->configId ? _eglInternalFindConfig(walkerDpy, currentCtx->configId) : walkerDpy->rootConfig;
 
-					return EGL_FALSE;
+					if (!walkerConfig || !__surfacelessSurface(&surfacelessSurfaceContainer, walkerDpy, walkerConfig))
+					{
+						g_localStorage.error = EGL_BAD_MATCH;
+
+						return EGL_FALSE;
+					}
+
+					nativeSurfaceContainer = &surfacelessSurfaceContainer;
+
+					surfaceConfigId = walkerConfig->configId;
 				}
 
-				EGLContextImpl* walkerCtx = walkerDpy->rootCtx;
+				// The native context is chosen by the draw surface. The read surface is only bound.
+				readSurfaceContainer = currentRead != EGL_NO_SURFACE ? &currentRead->nativeSurfaceContainer : nativeSurfaceContainer;
 
-				while (walkerCtx)
+				if (currentCtx != EGL_NO_CONTEXT)
 				{
-					if ((EGLContext)walkerCtx == ctx)
+					const EGLConfigImpl* surfaceConfig = 0;
+
+					EGLContextListImpl* ctxList = currentCtx->rootCtxList;
+
+					while (ctxList)
 					{
-						if (!walkerCtx->initialized || walkerCtx->destroy)
+						// Without a drawable, any native context of the context will do.
+						if (currentDraw == EGL_NO_SURFACE)
 						{
-							g_localStorage.error = EGL_BAD_CONTEXT;
-
-							return EGL_FALSE;
+							if (__isCompatibleContext(&ctxList->nativeContextContainer, nativeSurfaceContainer, EGL_FALSE))
+							{
+								break;
+							}
+						}
+						else if (ctxList->configId == surfaceConfigId)
+						{
+							if (__isCompatibleContext(&ctxList->nativeContextContainer, nativeSurfaceContainer, EGL_TRUE))
+							{
+								break;
+							}
 						}
+						// A context without configuration reuses native contexts of compatible configurations.
+						else if (currentCtx->configId == 0)
+						{
+							if (!surfaceConfig)
+							{
+								surfaceConfig = _eglInternalFindConfig(walkerDpy, surfaceConfigId);
+							}
 
-						walkerCtx->initialized = EGL_FALSE;
-						walkerCtx->destroy = EGL_TRUE;
+							if (_eglInternalCompatibleConfigs(_eglInternalFindConfig(walkerDpy, ctxList->configId), surfaceConfig) &&
+								__isCompatibleContext(&ctxList->nativeContextContainer, nativeSurfaceContainer, EGL_FALSE))
+							{
+								break;
+							}
+						}
 
-						success = EGL_TRUE;
-						break;
+						ctxList = ctxList->next;
 					}
 
-					walkerCtx = walkerCtx->next;
-				}
+					if (!ctxList)
+					{
+						// The native context of the context is created next. If the context shares, but no native
+						// context of its share chain exists yet, the one of the first context of the chain is created
+						// before, as all others share with it.
+						EGLContextImpl* ownerCtx = currentCtx;
+						EGLContextImpl* sharedCtx = currentCtx->rootCtxList ? currentCtx : 0;
 
-				g_localStorage.error = EGL_BAD_CONTEXT;
+						for (EGLContextImpl* sharedWalkerCtx = currentCtx->sharedCtx; sharedWalkerCtx && !sharedCtx; sharedWalkerCtx = sharedWalkerCtx->sharedCtx)
+						{
+							if (sharedWalkerCtx->rootCtxList)
+							{
+								sharedCtx = sharedWalkerCtx;
+							}
+							else if (!sharedWalkerCtx->sharedCtx)
+							{
+								ownerCtx = sharedWalkerCtx;
+							}
+						}
 
-				if (!success)
-					return EGL_FALSE;
-			}
+						const NativeContextContainer* sharedNativeContextContainer = sharedCtx ? _eglInternalShareContext(sharedCtx->rootCtxList, nativeSurfaceContainer) : 0;
 
-			walkerDpy = walkerDpy->next;
-		}
-	}
-	
-	if (success)
-		_eglInternalCleanup();
+						// The first native context of a share group shares with the display share context of its client
+						// API, so images are accessible across share groups. The share context is created at first use.
+						EGLShareGroupImpl* shareGroup = currentCtx->shareGroup;
 
-	g_localStorage.error = EGL_BAD_DISPLAY;
+						if (!sharedCtx && !noShareCtx)
+						{
+							const std::pair<EGLenum, EGLBoolean> shareKey(shareGroup->api, shareGroup->noError);
 
-	return EGL_FALSE;
-}
+							auto shareCtx = walkerDpy->shareCtxs.find(shareKey);
+
+							if (shareCtx == walkerDpy->shareCtxs.end())
+							{
+								NativeContextContainer newShareCtx;
+
+								_eglInternalAcquireCurrent(walkerDpy, currentDraw, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
+								ownerCtx->pendingCount++;
+
+								dpyLock.unlock();
+
+								result = __createContext(&newShareCtx, walkerDpy, nativeSurfaceContainer, 0, ownerCtx->attribList);
+
+								dpyLock.lock();
+
+								ownerCtx->pendingCount--;
+								_eglInternalReleaseCurrent(walkerDpy, currentDraw, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
+
+								if (result)
+								{
+									bool inserted = false;
+
+									try
+									{
+										inserted = walkerDpy->shareCtxs.emplace(shareKey, newShareCtx).second;
+									}
+									catch (const std::bad_alloc&)
+									{
+									}
+
+									// Another thread may have created the share context meanwhile.
+									if (!inserted)
+									{
+										dpyLock.unlock();
+
+										__deleteContext(walkerDpy, &newShareCtx);
+									}
+								}
+								else
+								{
+									noShareCtx = true;
+								}
+
+								// Everything is looked up again, as objects may have been destroyed meanwhile.
+								continue;
+							}
+
+							// Entries are only erased with the display, so the share context stays while unlocked.
+							sharedNativeContextContainer = &shareCtx->second;
+						}
+
+						ctxList = (EGLContextListImpl*)malloc(sizeof(EGLContextListImpl));
 
-EGLBoolean _eglDestroySurface(EGLDisplay dpy, EGLSurface surface)
-{
-	EGLBoolean success = EGL_FALSE;
+						if (!ctxList)
+						{
+							return EGL_FALSE;
+						}
 
-	{
-		auto _rl = g_globalStorage.placeRootDpy_readlock();
-		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+						// Creating a native context can block, so it is done without the display lock. The drawable and
+						// both contexts are pinned meanwhile, which keeps cleanup from deleting their native objects.
+						_eglInternalAcquireCurrent(walkerDpy, currentDraw, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
+						ownerCtx->pendingCount++;
+						if (sharedCtx)
+						{
+							sharedCtx->pendingCount++;
+						}
 
-		while (walkerDpy)
-		{
-			if ((EGLDisplay)walkerDpy == dpy)
-			{
-				guard_t _{ walkerDpy->mutex };
+						dpyLock.unlock();
 
-				if (!walkerDpy->initialized || walkerDpy->destroy)
-				{
-					g_localStorage.error = EGL_NOT_INITIALIZED;
+						result = __createContext(&ctxList->nativeContextContainer, walkerDpy, nativeSurfaceContainer, sharedNativeContextContainer, ownerCtx->attribList);
 
-					return EGL_FALSE;
-				}
+						dpyLock.lock();
 
-				EGLSurfaceImpl* walkerSurface = walkerDpy->rootSurface;
+						if (sharedCtx)
+						{
+							sharedCtx->pendingCount--;
+						}
+						ownerCtx->pendingCount--;
+						_eglInternalReleaseCurrent(walkerDpy, currentDraw, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
 
-				while (walkerSurface)
-				{
-					if ((EGLSurface)walkerSurface == surface)
-					{
-						if (!walkerSurface->initialized || walkerSurface->destroy)
+						if (!result)
 						{
-							g_localStorage.error = EGL_BAD_SURFACE;
+							free(ctxList);
 
 							return EGL_FALSE;
 						}
 
-						walkerSurface->initialized = EGL_FALSE;
-						walkerSurface->destroy = EGL_TRUE;
+						// Another thread may have created a native context of the chain meanwhile. One not sharing is
+						// dropped then, as all native contexts of the chain have to share with the same one.
+						if (!sharedCtx && ownerCtx->rootCtxList)
+						{
+							dpyLock.unlock();
 
-						__destroySurface(walkerDpy->display_id, walkerSurface);
+							__deleteContext(walkerDpy, &ctxList->nativeContextContainer);
 
-						success = EGL_TRUE;
-						break;
+							free(ctxList);
+						}
+						else
+						{
+							ctxList->configId = surfaceConfigId;
+
+							if (!sharedCtx)
+							{
+								shareGroup->displayShared = sharedNativeContextContainer != 0;
+							}
+
+							ctxList->next = ownerCtx->rootCtxList;
+							ownerCtx->rootCtxList = ctxList;
+						}
+
+						// Everything is looked up again, as objects may have been destroyed meanwhile.
+						continue;
 					}
 
-					walkerSurface = walkerSurface->next;
+					nativeContextContainer = &ctxList->nativeContextContainer;
 				}
 
-				g_localStorage.error = EGL_BAD_SURFACE;
+				_eglInternalAcquireCurrent(walkerDpy, currentDraw, currentRead, currentCtx);
 
-				if (!success)
-					return EGL_FALSE;
+				currentDpy = walkerDpy;
+
+				break; // break displays loop
 			}
 
 			walkerDpy = walkerDpy->next;
 		}
 	}
 
-	if (success)
-		_eglInternalCleanup();
+	if (!currentDpy)
+	{
+		g_localStorage.error = EGL_BAD_DISPLAY;
 
-	g_localStorage.error = EGL_BAD_DISPLAY;
+		return EGL_FALSE;
+	}
+
+	// The native call can block, so it is done without the display lock. The acquired objects stay alive meanwhile.
+	if (!__makeCurrent(currentDpy, nativeSurfaceContainer, readSurfaceContainer, nativeContextContainer))
+	{
+		_eglInternalReleaseCurrent(currentDpy, currentDraw, currentRead, currentCtx);
+
+		g_localStorage.error = EGL_BAD_MATCH;
+
+		return EGL_FALSE;
+	}
+
+	_eglInternalSetCurrent(currentDpy, currentDraw, currentRead, currentCtx);
 
-	return success;
+	_eglInternalCleanup();
+
+	return EGL_TRUE;
 }
 
-EGLBoolean _eglGetConfigAttrib(EGLDisplay dpy, EGLConfig config, EGLint attribute, EGLint *value)
+EGLBoolean _eglQueryContext (EGLDisplay dpy, EGLContext ctx, EGLint attribute, EGLint *value)
 {
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
-
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
 	while (walkerDpy)
@@ -1598,328 +3742,363 @@ EGLBoolean _eglGetConfigAttrib(EGLDisplay dpy, EGLConfig config, EGLint attribut
 				return EGL_FALSE;
 			}
 
-			EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
-
-			while (walkerConfig)
-			{
-				if ((EGLConfig)walkerConfig == config)
-				{
-					break;
-				}
-
-				walkerConfig = walkerConfig->next;
-			}
+			EGLContextImpl* walkerCtx = walkerDpy->ctxTable.lookup(ctx);
 
-			if (!walkerConfig)
+			if (!walkerCtx || !walkerCtx->initialized || walkerCtx->destroy)
 			{
-				g_localStorage.error = EGL_BAD_CONFIG;
+				g_localStorage.error = EGL_BAD_CONTEXT;
 
 				return EGL_FALSE;
 			}
 
 			switch (attribute)
 			{
-				case EGL_ALPHA_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->alphaSize;
-					}
-				}
-				break;
-				case EGL_ALPHA_MASK_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->alphaMaskSize;
-					}
-				}
-				break;
-				case EGL_BIND_TO_TEXTURE_RGB:
-				{
-					if (value)
-					{
-						*value = walkerConfig->bindToTextureRGB;
-					}
-				}
-				break;
-				case EGL_BIND_TO_TEXTURE_RGBA:
-				{
-					if (value)
-					{
-						*value = walkerConfig->bindToTextureRGBA;
-					}
-				}
-				break;
-				case EGL_BLUE_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->blueSize;
-					}
-				}
-				break;
-				case EGL_BUFFER_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->bufferSize;
-					}
-				}
-				break;
-				case EGL_COLOR_BUFFER_TYPE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->colorBufferType;
-					}
-				}
-				break;
-				case EGL_CONFIG_CAVEAT:
-				{
-					if (value)
-					{
-						*value = walkerConfig->configCaveat;
-					}
-				}
-				break;
 				case EGL_CONFIG_ID:
 				{
 					if (value)
 					{
-						*value = walkerConfig->configId;
-					}
-				}
-				break;
-				case EGL_CONFORMANT:
-				{
-					if (value)
-					{
-						*value = walkerConfig->conformant;
-					}
-				}
-				break;
-				case EGL_DEPTH_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->depthSize;
-					}
-				}
-				break;
-				case EGL_GREEN_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->greenSize;
-					}
-				}
-				break;
-				case EGL_LEVEL:
-				{
-					if (value)
-					{
-						*value = walkerConfig->level;
-					}
-				}
-				break;
-				case EGL_LUMINANCE_SIZE:
-				{
-					if (value)
-					{
-						*value = walkerConfig->luminanceSize;
-					}
-				}
-				break;
-				case EGL_MAX_PBUFFER_WIDTH:
-				{
-					if (value)
-					{
-						*value = walkerConfig->maxPBufferWidth;
-					}
-				}
-				break;
-				case EGL_MAX_PBUFFER_HEIGHT:
-				{
-					if (value)
-					{
-						*value = walkerConfig->maxPBufferHeight;
-					}
-				}
-				break;
-				case EGL_MAX_PBUFFER_PIXELS:
-				{
-					if (value)
-					{
-						*value = walkerConfig->maxPBufferPixels;
-					}
-				}
-				break;
-				case EGL_MAX_SWAP_INTERVAL:
-				{
-					if (value)
-					{
-						*value = walkerConfig->maxSwapInterval;
+						*value = walkerCtx->configId;
 					}
+
+					return EGL_TRUE;
 				}
 				break;
-				case EGL_MIN_SWAP_INTERVAL:
+				case EGL_CONTEXT_CLIENT_TYPE:
 				{
 					if (value)
 					{
-						*value = walkerConfig->minSwapInterval;
+						*value = EGL_OPENGL_API;
 					}
+
+					return EGL_TRUE;
 				}
 				break;
-				case EGL_NATIVE_RENDERABLE:
+				case EGL_CONTEXT_CLIENT_VERSION:
 				{
-					if (value)
-					{
-						*value = walkerConfig->nativeRenderable;
-					}
+					// Regarding the specification, it only makes sense for OpenGL ES.
+
+					return EGL_FALSE;
 				}
 				break;
-				case EGL_NATIVE_VISUAL_ID:
+				case EGL_RENDER_BUFFER:
 				{
-					if (value)
+					if (g_localStorage.currentCtx == walkerCtx)
 					{
-						*value = walkerConfig->nativeVisualId;
+						EGLSurfaceImpl* currentSurface = g_localStorage.currentDraw ? g_localStorage.currentDraw : g_localStorage.currentRead;
+
+						if (currentSurface)
+						{
+							if (currentSurface->drawToWindow)
+							{
+								if (value)
+								{
+									*value = currentSurface->doubleBuffer ? EGL_BACK_BUFFER : EGL_SINGLE_BUFFER;
+								}
+
+								return EGL_TRUE;
+							}
+							else if (currentSurface->drawToPixmap)
+							{
+								if (value)
+								{
+									*value = EGL_SINGLE_BUFFER;
+								}
+
+								return EGL_TRUE;
+							}
+							else if (currentSurface->drawToPBuffer)
+							{
+								if (value)
+								{
+									*value = EGL_BACK_BUFFER;
+								}
+
+								return EGL_TRUE;
+							}
+						}
+
+						if (value)
+						{
+							*value = EGL_NONE;
+						}
+
+						return EGL_FALSE;
 					}
-				}
-				break;
-				case EGL_NATIVE_VISUAL_TYPE:
-				{
-					if (value)
+					else
 					{
-						*value = walkerConfig->nativeVisualType;
+						if (value)
+						{
+							*value = EGL_NONE;
+						}
+
+						return EGL_FALSE;
 					}
 				}
 				break;
-				case EGL_RED_SIZE:
+			}
+
+			g_localStorage.error = EGL_BAD_PARAMETER;
+
+			return EGL_FALSE;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_FALSE;
+}
+
+const char *_eglQueryString(EGLDisplay dpy, EGLint name)
+{
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			guard_t _{ walkerDpy->mutex };
+
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
+
+				return 0;
+			}
+
+			switch (name)
+			{
+				case EGL_CLIENT_APIS:
 				{
-					if (value)
-					{
-						*value = walkerConfig->redSize;
-					}
+					return "EGL_OPENGL_API";
 				}
 				break;
-				case EGL_RENDERABLE_TYPE:
+				case EGL_VENDOR:
 				{
-					if (value)
-					{
-						*value = walkerConfig->renderableType;
-					}
+					return _EGL_VENDOR;
 				}
 				break;
-				case EGL_SAMPLE_BUFFERS:
+				case EGL_VERSION:
 				{
-					if (value)
-					{
-						*value = walkerConfig->sampleBuffers;
-					}
+					return _EGL_VERSION;
 				}
 				break;
-				case EGL_SAMPLES:
+				case EGL_EXTENSIONS:
 				{
-					if (value)
-					{
-						*value = walkerConfig->samples;
-					}
+					return walkerDpy->extensions.c_str();
 				}
 				break;
-				case EGL_STENCIL_SIZE:
+			}
+
+			g_localStorage.error = EGL_BAD_PARAMETER;
+
+			return 0;
+		}
+
+		walkerDpy = walkerDpy->next;
+	}
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return 0;
+}
+
+EGLBoolean _eglQuerySurface (EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint *value)
+{
+	// TODO Implement querying a surface.
+
+	return EGL_FALSE;
+}
+
+EGLBoolean _eglSwapBuffers(EGLDisplay dpy, EGLSurface surface)
+{
+	EGLDisplayImpl* swapDpy = 0;
+	EGLSurfaceImpl* swapSurface = EGL_NO_SURFACE_IMPL;
+
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
+			{
+				guard_t _{ walkerDpy->mutex };
+
+				if (!walkerDpy->initialized || walkerDpy->destroy)
 				{
-					if (value)
-					{
-						*value = walkerConfig->stencilSize;
-					}
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return 0;
 				}
-				break;
-				case EGL_SURFACE_TYPE:
+
+				EGLSurfaceImpl* walkerSurface = walkerDpy->surfaceTable.lookup(surface);
+
+				if (!walkerSurface || !walkerSurface->initialized || walkerSurface->destroy)
 				{
-					if (value)
-					{
-						*value = walkerConfig->surfaceType;
-					}
+					g_localStorage.error = EGL_BAD_SURFACE;
+
+					return EGL_FALSE;
 				}
+
+				_eglInternalAcquireCurrent(walkerDpy, walkerSurface, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
+
+				swapDpy = walkerDpy;
+				swapSurface = walkerSurface;
+
 				break;
-				case EGL_TRANSPARENT_TYPE:
+			}
+
+			walkerDpy = walkerDpy->next;
+		}
+	}
+
+	if (!swapDpy)
+	{
+		g_localStorage.error = EGL_BAD_DISPLAY;
+
+		return EGL_FALSE;
+	}
+
+	// Swapping may wait for the vertical blank, so other threads must not wait for the display lock meanwhile.
+	EGLBoolean result = __swapBuffers(swapDpy, swapSurface);
+
+	_eglInternalReleaseCurrent(swapDpy, swapSurface, EGL_NO_SURFACE_IMPL, EGL_NO_CONTEXT_IMPL);
+
+	return result;
+}
+
+EGLBoolean _eglTerminate(EGLDisplay dpy)
+{
+	EGLBoolean success = EGL_FALSE;
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
+			{
+				guard_t _{ walkerDpy->mutex };
+
+				if (!walkerDpy->initialized || walkerDpy->destroy)
 				{
-					if (value)
-					{
-						*value = walkerConfig->transparentType;
-					}
+					g_localStorage.error = EGL_BAD_DISPLAY;
+
+					return EGL_FALSE;
 				}
-				break;
-				case EGL_TRANSPARENT_RED_VALUE:
+
+				walkerDpy->initialized.store(EGL_FALSE, std::memory_order_release);
+				walkerDpy->destroy.store(EGL_TRUE, std::memory_order_release);
+
+				walkerDpy->chooseConfigCache.clear();
+
+				// All objects are retired. Current ones are reclaimed, once released by their threads.
+				while (walkerDpy->rootSurface)
 				{
-					if (value)
-					{
-						*value = walkerConfig->transparentRedValue;
-					}
+					walkerDpy->rootSurface->initialized = EGL_FALSE;
+					walkerDpy->rootSurface->destroy.store(EGL_TRUE, std::memory_order_release);
+
+					_eglInternalRetire(&walkerDpy->rootSurface, &walkerDpy->retiredSurfaces, walkerDpy->rootSurface);
 				}
-				break;
-				case EGL_TRANSPARENT_GREEN_VALUE:
+
+				while (walkerDpy->rootCtx)
 				{
-					if (value)
-					{
-						*value = walkerConfig->transparentGreenValue;
-					}
+					walkerDpy->rootCtx->initialized = EGL_FALSE;
+					walkerDpy->rootCtx->destroy.store(EGL_TRUE, std::memory_order_release);
+
+					_eglInternalRetire(&walkerDpy->rootCtx, &walkerDpy->retiredCtxs, walkerDpy->rootCtx);
 				}
-				break;
-				case EGL_TRANSPARENT_BLUE_VALUE:
+
+				while (walkerDpy->rootSync)
 				{
-					if (value)
-					{
-						*value = walkerConfig->transparentBlueValue;
-					}
+					walkerDpy->rootSync->destroy = EGL_TRUE;
+
+					_eglInternalRetire(&walkerDpy->rootSync, &walkerDpy->retiredSyncs, walkerDpy->rootSync);
 				}
-				break;
-				default:
+
+				while (walkerDpy->rootImage)
 				{
-					g_localStorage.error = EGL_BAD_ATTRIBUTE;
+					walkerDpy->rootImage->destroy = EGL_TRUE;
 
-					return EGL_FALSE;
+					_eglInternalRetire(&walkerDpy->rootImage, &walkerDpy->retiredImages, walkerDpy->rootImage);
 				}
+
+				// Counted until the display itself is deleted.
+				g_globalStorage.retiredCount++;
+
+				success = EGL_TRUE;
 				break;
 			}
 
-			return EGL_TRUE;
+			walkerDpy = walkerDpy->next;
 		}
-
-		walkerDpy = walkerDpy->next;
 	}
 
-	
+	if (success)
+	{
+		_eglInternalCleanup();
+
+		return EGL_TRUE;
+	}
 
 	g_localStorage.error = EGL_BAD_DISPLAY;
 
 	return EGL_FALSE;
 }
 
-EGLBoolean _eglGetConfigs(EGLDisplay dpy, EGLConfig *configs, EGLint config_size, EGLint *num_config)
+
+
+EGLBoolean _eglWaitNative(EGLint engine)
 {
-	if (!configs)
+	if (engine != EGL_CORE_NATIVE_ENGINE)
 	{
 		g_localStorage.error = EGL_BAD_PARAMETER;
 
 		return EGL_FALSE;
 	}
 
-	if (config_size == 0)
+	// The current display is kept alive by the binding of this thread.
+	EGLDisplayImpl* walkerDpy = g_localStorage.currentDpy;
+
+	if (walkerDpy)
 	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+		guard_t _{ walkerDpy->mutex };
 
-		return EGL_FALSE;
+		if (g_localStorage.currentDraw && (!g_localStorage.currentDraw->initialized || g_localStorage.currentDraw->destroy))
+		{
+			g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
+
+			return EGL_FALSE;
+		}
+
+		if (g_localStorage.currentRead && (!g_localStorage.currentRead->initialized || g_localStorage.currentRead->destroy))
+		{
+			g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
+
+			return EGL_FALSE;
+		}
 	}
 
-	if (!num_config)
+	// Native rendering only has to be complete, before GL continues. There is nothing to wait for without a context.
+	if (walkerDpy && !__waitNative(walkerDpy))
 	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+		g_localStorage.error = EGL_BAD_MATCH;
 
 		return EGL_FALSE;
 	}
 
+	return EGL_TRUE;
+}
+
+//
+// EGL_VERSION_1_1
+//
+
+EGLBoolean _eglSwapInterval(EGLDisplay dpy, EGLint interval)
+{
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
@@ -1931,27 +4110,26 @@ EGLBoolean _eglGetConfigs(EGLDisplay dpy, EGLConfig *configs, EGLint config_size
 
 			if (!walkerDpy->initialized || walkerDpy->destroy)
 			{
-				g_localStorage.error = EGL_NOT_INITIALIZED;
+				g_localStorage.error = EGL_BAD_DISPLAY;
 
 				return EGL_FALSE;
 			}
 
-			EGLConfigImpl* walkerConfig = walkerDpy->rootConfig;
+			if (g_localStorage.currentCtx == EGL_NO_CONTEXT || g_localStorage.currentDpy != walkerDpy)
+			{
+				g_localStorage.error = EGL_BAD_CONTEXT;
 
-			EGLint configIndex = 0;
+				return EGL_FALSE;
+			}
 
-			while (walkerConfig && configIndex < config_size)
+			if (g_localStorage.currentDraw == EGL_NO_SURFACE || g_localStorage.currentRead == EGL_NO_SURFACE)
 			{
-				configs[configIndex] = walkerConfig;
-
-				walkerConfig = walkerConfig->next;
+				g_localStorage.error = EGL_BAD_SURFACE;
 
-				configIndex++;
+				return EGL_FALSE;
 			}
 
-			*num_config = configIndex;
-
-			return EGL_TRUE;
+			return __swapInterval(walkerDpy, g_localStorage.currentDraw, interval);
 		}
 
 		walkerDpy = walkerDpy->next;
@@ -1962,131 +4140,86 @@ EGLBoolean _eglGetConfigs(EGLDisplay dpy, EGLConfig *configs, EGLint config_size
 	return EGL_FALSE;
 }
 
-EGLDisplay _eglGetCurrentDisplay(void)
+//
+// EGL_VERSION_1_2
+//
+
+EGLBoolean _eglBindAPI(EGLenum api)
 {
-	if (g_localStorage.currentCtx == EGL_NO_CONTEXT)
+	if (api == EGL_OPENGL_API || api == EGL_OPENGL_ES_API)
 	{
-		return EGL_NO_DISPLAY;
-	}
+		g_localStorage.api = api;
 
-	auto _rl = g_globalStorage.placeRootDpy_readlock();
-	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+		return EGL_TRUE;
+	}
 
-	while (walkerDpy)
-	{
-		if (walkerDpy->currentCtx == g_localStorage.currentCtx)
-		{
-			return (EGLDisplay)walkerDpy;
-		}
+	g_localStorage.error = EGL_BAD_PARAMETER;
 
-		walkerDpy = walkerDpy->next;
-	}
-	
+	return EGL_FALSE;
+}
 
-	return EGL_NO_DISPLAY;
+EGLenum _eglQueryAPI(void)
+{
+	return g_localStorage.api;
 }
 
-EGLSurface _eglGetCurrentSurface(EGLint readdraw)
+EGLBoolean _eglWaitClient(void)
 {
 	if (g_localStorage.currentCtx == EGL_NO_CONTEXT)
 	{
-		return EGL_NO_SURFACE;
+		return EGL_TRUE;
 	}
 
-	auto _rl = g_globalStorage.placeRootDpy_readlock();
-	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+	// The current display is kept alive by the binding of this thread.
+	EGLDisplayImpl* walkerDpy = g_localStorage.currentDpy;
 
-	while (walkerDpy)
 	{
-		if (walkerDpy->currentCtx == g_localStorage.currentCtx)
-		{
-			if (readdraw == EGL_DRAW)
-			{
-				return (EGLSurface)walkerDpy->currentDraw;
-			}
-			else if (readdraw == EGL_READ)
-			{
-				return (EGLSurface)walkerDpy->currentRead;
-			}
+		guard_t _{ walkerDpy->mutex };
 
-			return EGL_NO_SURFACE;
+		if (!walkerDpy->initialized || walkerDpy->destroy)
+		{
+			return EGL_FALSE;
 		}
 
-		walkerDpy = walkerDpy->next;
-	}
-
-	return EGL_NO_SURFACE;
-}
-
-EGLDisplay _eglGetDisplay(EGLNativeDisplayType display_id)
-{
-	if (!_eglInternalInit())
-	{
-		return EGL_NO_DISPLAY;
-	}
-
-	//
-	{
-		auto _rl = g_globalStorage.placeRootDpy_readlock();
-
-		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
-
-		while (walkerDpy)
+		if (g_localStorage.currentDraw && (!g_localStorage.currentDraw->initialized || g_localStorage.currentDraw->destroy))
 		{
-			if (walkerDpy->display_id == display_id)
-			{
-				return (EGLDisplay)walkerDpy;
-			}
+			g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
 
-			walkerDpy = walkerDpy->next;
+			return EGL_FALSE;
 		}
-	}
 
-	EGLDisplayImpl* newDpy = new EGLDisplayImpl();
+		if (g_localStorage.currentRead && (!g_localStorage.currentRead->initialized || g_localStorage.currentRead->destroy))
+		{
+			g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
 
-	if (!newDpy)
-	{
-		return EGL_NO_DISPLAY;
+			return EGL_FALSE;
+		}
 	}
 
-	newDpy->initialized = EGL_FALSE;
-	newDpy->destroy = EGL_FALSE;
-#if defined(_WIN32) || defined(_WIN64)
-	newDpy->display_id = display_id ? display_id : g_globalStorage.dummy_read().hdc;
-#elif defined(__ANDROID__) || defined(ANDROID) || defined(WL_EGL_PLATFORM)
-	newDpy->display_id = 0;
-#else
-	newDpy->display_id = display_id ? display_id : g_globalStorage.dummy_read().display;
-#endif
-	newDpy->rootSurface = 0;
-	newDpy->rootCtx = 0;
-	newDpy->rootConfig = 0;
-	newDpy->currentDraw = EGL_NO_SURFACE_IMPL;
-	newDpy->currentRead = EGL_NO_SURFACE_IMPL;
-	newDpy->currentCtx = EGL_NO_CONTEXT_IMPL;
-	newDpy->next = g_globalStorage.rootDpy;
-
-	auto _wl = g_globalStorage.placeRootDpy_writelock();
-	g_globalStorage.rootDpy = newDpy;
+	// All contexts are OpenGL contexts, so the bound API does not matter.
+	_eglInternalFinish();
 
-	return newDpy;
+	return EGL_TRUE;
 }
 
-EGLint _eglGetError(void)
-{
-	EGLint currentError = g_localStorage.error;
-
-	g_localStorage.error = EGL_SUCCESS;
+//
+// EGL_VERSION_1_3
+//
 
-	return currentError;
-}
+//
+// EGL_VERSION_1_4
+//
 
-__eglMustCastToProperFunctionPointerType _eglGetProcAddress(const char *procname)
+EGLContext _eglGetCurrentContext(void)
 {
-	return __getProcAddress(procname);
+	return g_localStorage.currentCtx ? g_localStorage.currentCtx->handle : EGL_NO_CONTEXT;
 }
 
-EGLBoolean _eglInitialize(EGLDisplay dpy, EGLint *major, EGLint *minor)
+//
+// EGL_VERSION_1_5
+//
+
+static EGLSync _eglInternalCreateSync(EGLDisplay dpy, EGLenum type, EGLBoolean hasAttributes)
 {
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
@@ -2097,312 +4230,285 @@ EGLBoolean _eglInitialize(EGLDisplay dpy, EGLint *major, EGLint *minor)
 		{
 			guard_t _{ walkerDpy->mutex };
 
-			if (walkerDpy->destroy)
+			if (!walkerDpy->initialized || walkerDpy->destroy)
 			{
 				g_localStorage.error = EGL_NOT_INITIALIZED;
 
-				return EGL_FALSE;
+				return EGL_NO_SYNC;
 			}
 
+			// None of the supported types has attributes.
+			if (hasAttributes)
 			{
-				auto dummy = g_globalStorage.dummy_read();
-				EGLBoolean fail = (!walkerDpy->initialized && !__initialize(walkerDpy, &dummy, &g_localStorage.error));
-				g_globalStorage.dummy_write(dummy);
-				if (fail)
-				{
-					return EGL_FALSE;
-				}
-			}
-
-			walkerDpy->initialized = EGL_TRUE;
-
-
-			//
+				g_localStorage.error = EGL_BAD_ATTRIBUTE;
 
-			if (major)
-			{
-				*major = 1;
+				return EGL_NO_SYNC;
 			}
 
-			if (minor)
+			if (type != EGL_SYNC_FENCE && type != EGL_SYNC_REUSABLE_KHR)
 			{
-				*minor = 5;
-			}
-
-			return EGL_TRUE;
-		}
-
-		walkerDpy = walkerDpy->next;
-	}
-
-	g_localStorage.error = EGL_BAD_DISPLAY;
-
-	return EGL_FALSE;
-}
-
-EGLBoolean _eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx)
-{
-	EGLBoolean success = EGL_FALSE;
-	{
-		auto _rl = g_globalStorage.placeRootDpy_readlock();
-		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+				g_localStorage.error = EGL_BAD_PARAMETER;
 
-		if ((ctx == EGL_NO_CONTEXT && (draw != EGL_NO_SURFACE || read != EGL_NO_SURFACE)) || (ctx != EGL_NO_CONTEXT && (draw == EGL_NO_SURFACE || read == EGL_NO_SURFACE)))
-		{
-			g_localStorage.error = EGL_BAD_MATCH;
+				return EGL_NO_SYNC;
+			}
 
-			return EGL_FALSE;
-		}
+			// A fence is inserted into the command stream of the current context.
+			const GLSyncFunctions* gl = 0;
 
-		while (walkerDpy)
-		{
-			if ((EGLDisplay)walkerDpy == dpy)
+			if (type == EGL_SYNC_FENCE)
 			{
-				guard_t _{ walkerDpy->mutex };
-
-				if (!walkerDpy->initialized || walkerDpy->destroy)
+				if (g_localStorage.currentCtx == EGL_NO_CONTEXT || g_localStorage.currentDpy != walkerDpy)
 				{
-					g_localStorage.error = EGL_NOT_INITIALIZED;
+					g_localStorage.error = EGL_BAD_MATCH;
 
-					return EGL_FALSE;
+					return EGL_NO_SYNC;
 				}
 
-				EGLSurfaceImpl* currentDraw = EGL_NO_SURFACE_IMPL;
-				EGLSurfaceImpl* currentRead = EGL_NO_SURFACE_IMPL;
-				EGLContextImpl* currentCtx = EGL_NO_CONTEXT_IMPL;
-
-				NativeSurfaceContainer* nativeSurfaceContainer = 0;
-				NativeContextContainer* nativeContextContainer = 0;
-
-				EGLBoolean result;
+				gl = _eglInternalGetSyncFunctions();
 
-				if (draw != EGL_NO_SURFACE)
+				if (!gl)
 				{
-					EGLSurfaceImpl* walkerSurface = walkerDpy->rootSurface;
-
-					while (walkerSurface)
-					{
-						if ((EGLSurface)walkerSurface == draw)
-						{
-							if (!walkerSurface->initialized || walkerSurface->destroy)
-							{
-								g_localStorage.error = EGL_BAD_NATIVE_WINDOW;
-
-								return EGL_FALSE;
-							}
-
-							currentDraw = walkerSurface;
-
-							break;
-						}
-
-						walkerSurface = walkerSurface->next;
-					}
-
-					if (!currentDraw)
-					{
-						g_localStorage.error = EGL_BAD_SURFACE;
+					g_localStorage.error = EGL_BAD_MATCH;
 
-						return EGL_FALSE;
-					}
+					return EGL_NO_SYNC;
 				}
+			}
 
-				if (read != EGL_NO_SURFACE)
-				{
-					EGLSurfaceImpl* walkerSurface = walkerDpy->rootSurface;
+			EGLSyncImpl* newSync = (EGLSyncImpl*)malloc(sizeof(EGLSyncImpl));
 
-					while (walkerSurface)
-					{
-						if ((EGLSurface)walkerSurface == read)
-						{
-							if (!walkerSurface->initialized || walkerSurface->destroy)
-							{
-								g_localStorage.error = EGL_BAD_NATIVE_WINDOW;
+			if (!newSync)
+			{
+				g_localStorage.error = EGL_BAD_ALLOC;
 
-								return EGL_FALSE;
-							}
+				return EGL_NO_SYNC;
+			}
 
-							currentRead = walkerSurface;
+			newSync->fence = 0;
+			newSync->shareGroup = 0;
 
-							break;
-						}
+			if (gl)
+			{
+				newSync->fence = gl->fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
-						walkerSurface = walkerSurface->next;
-					}
+				if (!newSync->fence)
+				{
+					free(newSync);
 
-					if (!currentRead)
-					{
-						g_localStorage.error = EGL_BAD_SURFACE;
+					g_localStorage.error = EGL_BAD_ALLOC;
 
-						return EGL_FALSE;
-					}
+					return EGL_NO_SYNC;
 				}
 
-				if (ctx != EGL_NO_CONTEXT)
-				{
-					EGLContextImpl* walkerCtx = walkerDpy->rootCtx;
+				// Any thread may wait for the fence, so it has to signal without further flushes of its context.
+				gl->flush();
 
-					while (walkerCtx)
-					{
-						if ((EGLContext)walkerCtx == ctx)
-						{
-							if (!walkerCtx->initialized || walkerCtx->destroy)
-							{
-								g_localStorage.error = EGL_BAD_CONTEXT;
+				newSync->shareGroup = g_localStorage.currentCtx->shareGroup;
+			}
 
-								return EGL_FALSE;
-							}
+			newSync->handle = walkerDpy->syncTable.insert(newSync);
 
-							currentCtx = walkerCtx;
+			if (!newSync->handle)
+			{
+				if (gl)
+				{
+					gl->deleteSync(newSync->fence);
+				}
 
-							break;
-						}
+				free(newSync);
 
-						walkerCtx = walkerCtx->next;
-					}
+				g_localStorage.error = EGL_BAD_ALLOC;
 
-					if (!currentCtx)
-					{
-						g_localStorage.error = EGL_BAD_CONTEXT;
+				return EGL_NO_SYNC;
+			}
 
-						return EGL_FALSE;
-					}
-				}
+			newSync->destroy = EGL_FALSE;
+			newSync->type = type;
+			newSync->status = EGL_UNSIGNALED;
+			newSync->waitCount = 0;
 
-				if (currentDraw != EGL_NO_SURFACE)
-				{
-					nativeSurfaceContainer = &currentDraw->nativeSurfaceContainer;
-				}
+			if (newSync->shareGroup)
+			{
+				newSync->shareGroup->refCount++;
+			}
 
-				if (currentCtx != EGL_NO_CONTEXT)
-				{
-					EGLContextListImpl* ctxList = currentCtx->rootCtxList;
+			_eglInternalLink(&walkerDpy->rootSync, newSync);
 
-					while (ctxList)
-					{
-						if (ctxList->surface == currentDraw)
-						{
-							break;
-						}
+			return newSync->handle;
+		}
 
-						ctxList = ctxList->next;
-					}
+		walkerDpy = walkerDpy->next;
+	}
 
-					if (!ctxList)
-					{
-						ctxList = (EGLContextListImpl*)malloc(sizeof(EGLContextListImpl));
+	g_localStorage.error = EGL_BAD_DISPLAY;
 
-						if (!ctxList)
-						{
-							return EGL_FALSE;
-						}
+	return EGL_NO_SYNC;
+}
 
-						// Gather shared context, if one exists.
-						EGLContextListImpl* sharedCtxList = 0;
-						if (currentCtx->sharedCtx)
-						{
-							EGLContextImpl* sharedWalkerCtx = currentCtx->sharedCtx;
-							EGLContextImpl* beforeSharedWalkerCtx = 0;
+EGLSync _eglCreateSync(EGLDisplay dpy, EGLenum type, const EGLAttrib* attrib_list)
+{
+	return _eglInternalCreateSync(dpy, type, attrib_list && attrib_list[0] != EGL_NONE);
+}
 
-							while (sharedWalkerCtx)
-							{
-								// Check, if already created.
-								if (sharedWalkerCtx->rootCtxList)
-								{
-									sharedCtxList = sharedWalkerCtx->rootCtxList;
+EGLSync _eglCreateSyncKHR(EGLDisplay dpy, EGLenum type, const EGLint* attrib_list)
+{
+	return _eglInternalCreateSync(dpy, type, attrib_list && attrib_list[0] != EGL_NONE);
+}
 
-									break;
-								}
+EGLBoolean _eglDestroySync(EGLDisplay dpy, EGLSync sync)
+{
+	EGLBoolean success = EGL_FALSE;
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
-								beforeSharedWalkerCtx = sharedWalkerCtx;
-								sharedWalkerCtx = sharedWalkerCtx->sharedCtx;
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
+			{
+				guard_t _{ walkerDpy->mutex };
 
-								// No created shared context found.
-								if (!sharedWalkerCtx)
-								{
-									sharedCtxList = (EGLContextListImpl*)malloc(sizeof(EGLContextListImpl));
+				if (!walkerDpy->initialized || walkerDpy->destroy)
+				{
+					g_localStorage.error = EGL_NOT_INITIALIZED;
 
-									if (!sharedCtxList)
-									{
-										free(ctxList);
+					return EGL_FALSE;
+				}
 
-										return EGL_FALSE;
-									}
+				EGLSyncImpl* walkerSync = walkerDpy->syncTable.lookup(sync);
 
-									result = __createContext(&sharedCtxList->nativeContextContainer, walkerDpy, &currentDraw->nativeSurfaceContainer, 0, beforeSharedWalkerCtx->attribList);
+				if (!walkerSync || walkerSync->destroy)
+				{
+					g_localStorage.error = EGL_BAD_PARAMETER;
 
-									if (!result)
-									{
-										free(sharedCtxList);
+					return EGL_FALSE;
+				}
 
-										free(ctxList);
+				// Freed by cleanup, after all waits have returned.
+				walkerSync->destroy = EGL_TRUE;
 
-										return EGL_FALSE;
-									}
+				_eglInternalRetire(&walkerDpy->rootSync, &walkerDpy->retiredSyncs, walkerSync);
 
-									sharedCtxList->surface = currentDraw;
+				success = EGL_TRUE;
+				break;
+			}
 
-									sharedCtxList->next = beforeSharedWalkerCtx->rootCtxList;
-									beforeSharedWalkerCtx->rootCtxList = sharedCtxList;
-								}
-							}
-						}
-						else
-						{
-							// Use own context as shared context, if one exits.
+			walkerDpy = walkerDpy->next;
+		}
+	}
 
-							sharedCtxList = currentCtx->rootCtxList;
-						}
+	if (success)
+	{
+		_eglInternalCleanup();
 
-						result = __createContext(&ctxList->nativeContextContainer, walkerDpy, &currentDraw->nativeSurfaceContainer, sharedCtxList ? &sharedCtxList->nativeContextContainer : 0, currentCtx->attribList);
+		return EGL_TRUE;
+	}
 
-						if (!result)
-						{
-							free(ctxList);
+	g_localStorage.error = EGL_BAD_DISPLAY;
 
-							return EGL_FALSE;
-						}
+	return EGL_FALSE;
+}
 
-						ctxList->surface = currentDraw;
+EGLint _eglClientWaitSync(EGLDisplay dpy, EGLSync sync, EGLint flags, EGLTime timeout)
+{
+	// Kept alive by the wait.
+	EGLSyncImpl* waitSync = 0;
+	{
+		auto _rl = g_globalStorage.placeRootDpy_readlock();
+		EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
-						ctxList->next = currentCtx->rootCtxList;
-						currentCtx->rootCtxList = ctxList;
-					}
+		while (walkerDpy)
+		{
+			if ((EGLDisplay)walkerDpy == dpy)
+			{
+				guard_t _{ walkerDpy->mutex };
 
-					nativeContextContainer = &ctxList->nativeContextContainer;
+				if (!walkerDpy->initialized || walkerDpy->destroy)
+				{
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return EGL_FALSE;
 				}
 
-				success = result = __makeCurrent(walkerDpy, nativeSurfaceContainer, nativeContextContainer);
+				EGLSyncImpl* walkerSync = walkerDpy->syncTable.lookup(sync);
 
-				if (!result)
+				if (!walkerSync || walkerSync->destroy)
 				{
-					g_localStorage.error = EGL_BAD_MATCH;
+					g_localStorage.error = EGL_BAD_PARAMETER;
 
 					return EGL_FALSE;
 				}
 
-				walkerDpy->currentDraw = currentDraw;
-				walkerDpy->currentRead = currentRead;
-				walkerDpy->currentCtx = currentCtx;
+				// Keeps the sync alive, while waiting without the display lock.
+				walkerSync->waitCount++;
 
-				g_localStorage.currentCtx = currentCtx;
-
-				break; // break displays loop
+				waitSync = walkerSync;
+				break;
 			}
 
 			walkerDpy = walkerDpy->next;
 		}
 	}
 
-	if (success)
-		_eglInternalCleanup();
+	if (!waitSync)
+	{
+		g_localStorage.error = EGL_BAD_DISPLAY;
 
-	g_localStorage.error = EGL_BAD_DISPLAY;
+		return EGL_FALSE;
+	}
+
+	EGLint result = EGL_CONDITION_SATISFIED;
+
+	if (waitSync->type == EGL_SYNC_REUSABLE_KHR)
+	{
+		// Only signaled from the CPU, so the calling thread just sleeps.
+		result = _eglInternalWaitSync(waitSync, timeout);
+	}
+	else if (waitSync->status != EGL_SIGNALED)
+	{
+		const GLSyncFunctions* gl = _eglInternalCanAccessFence(waitSync) ? _eglInternalGetSyncFunctions() : 0;
+
+		if (gl)
+		{
+			GLbitfield glFlags = (flags & EGL_SYNC_FLUSH_COMMANDS_BIT) ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+			GLenum glResult;
+
+			// A client wait has no infinite timeout in GL, so wait in the largest steps possible.
+			do
+			{
+				glResult = gl->clientWaitSync(waitSync->fence, glFlags, (uint64_t)timeout);
+				glFlags = 0;
+			}
+			while (glResult == GL_TIMEOUT_EXPIRED && timeout == EGL_FOREVER);
+
+			switch (glResult)
+			{
+				case GL_ALREADY_SIGNALED:
+				case GL_CONDITION_SATISFIED:
+					waitSync->status = EGL_SIGNALED;
+					break;
+				case GL_TIMEOUT_EXPIRED:
+					result = EGL_TIMEOUT_EXPIRED;
+					break;
+				default:
+					g_localStorage.error = EGL_BAD_ACCESS;
+					result = EGL_FALSE;
+					break;
+			}
+		}
+		else
+		{
+			// The fence only exists in its share group, so it can only be waited for with a context of the group current.
+			g_localStorage.error = EGL_BAD_MATCH;
+			result = EGL_FALSE;
+		}
+	}
+
+	waitSync->waitCount--;
 
-	return success;
+	return result;
 }
 
-EGLBoolean _eglQueryContext (EGLDisplay dpy, EGLContext ctx, EGLint attribute, EGLint *value)
+EGLBoolean _eglSignalSyncKHR(EGLDisplay dpy, EGLSync sync, EGLenum mode)
 {
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
@@ -2420,114 +4526,91 @@ EGLBoolean _eglQueryContext (EGLDisplay dpy, EGLContext ctx, EGLint attribute, E
 				return EGL_FALSE;
 			}
 
-			EGLContextImpl* walkerCtx = walkerDpy->rootCtx;
+			EGLSyncImpl* walkerSync = walkerDpy->syncTable.lookup(sync);
 
-			while (walkerCtx)
+			if (!walkerSync || walkerSync->destroy || (mode != EGL_SIGNALED && mode != EGL_UNSIGNALED))
 			{
-				if ((EGLContext)walkerCtx == ctx)
-				{
-					if (!walkerCtx->initialized || walkerCtx->destroy)
-					{
-						return EGL_FALSE;
-					}
+				g_localStorage.error = EGL_BAD_PARAMETER;
 
-					switch (attribute)
-					{
-						case EGL_CONFIG_ID:
-						{
-							if (value)
-							{
-								*value = walkerCtx->configId;
-							}
+				return EGL_FALSE;
+			}
 
-							return EGL_TRUE;
-						}
-						break;
-						case EGL_CONTEXT_CLIENT_TYPE:
-						{
-							if (value)
-							{
-								*value = EGL_OPENGL_API;
-							}
+			if (walkerSync->type != EGL_SYNC_REUSABLE_KHR)
+			{
+				g_localStorage.error = EGL_BAD_MATCH;
 
-							return EGL_TRUE;
-						}
-						break;
-						case EGL_CONTEXT_CLIENT_VERSION:
-						{
-							// Regarding the specification, it only makes sense for OpenGL ES.
+				return EGL_FALSE;
+			}
 
-							return EGL_FALSE;
-						}
-						break;
-						case EGL_RENDER_BUFFER:
-						{
-							if (walkerDpy->currentCtx == walkerCtx)
-							{
-								EGLSurfaceImpl* currentSurface = walkerDpy->currentDraw ? walkerDpy->currentDraw : walkerDpy->currentRead;
+			// Waiters only need to be woken, if the status changes to signaled.
+			if (walkerSync->status.exchange((EGLint)mode) != EGL_SIGNALED && mode == EGL_SIGNALED)
+			{
+				_eglInternalWakeSync(walkerSync);
+			}
 
-								if (currentSurface)
-								{
-									if (currentSurface->drawToWindow)
-									{
-										if (value)
-										{
-											*value = currentSurface->doubleBuffer ? EGL_BACK_BUFFER : EGL_SINGLE_BUFFER;
-										}
+			return EGL_TRUE;
+		}
 
-										return EGL_TRUE;
-									}
-									else if (currentSurface->drawToPixmap)
-									{
-										if (value)
-										{
-											*value = EGL_SINGLE_BUFFER;
-										}
+		walkerDpy = walkerDpy->next;
+	}
 
-										return EGL_TRUE;
-									}
-									else if (currentSurface->drawToPBuffer)
-									{
-										if (value)
-										{
-											*value = EGL_BACK_BUFFER;
-										}
+	g_localStorage.error = EGL_BAD_DISPLAY;
 
-										return EGL_TRUE;
-									}
-								}
+	return EGL_FALSE;
+}
 
-								if (value)
-								{
-									*value = EGL_NONE;
-								}
+EGLBoolean _eglWaitSync(EGLDisplay dpy, EGLSync sync, EGLint flags)
+{
+	auto _rl = g_globalStorage.placeRootDpy_readlock();
+	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
-								return EGL_FALSE;
-							}
-							else
-							{
-								if (value)
-								{
-									*value = EGL_NONE;
-								}
+	while (walkerDpy)
+	{
+		if ((EGLDisplay)walkerDpy == dpy)
+		{
+			guard_t _{ walkerDpy->mutex };
 
-								return EGL_FALSE;
-							}
-						}
-						break;
-					}
+			if (!walkerDpy->initialized || walkerDpy->destroy)
+			{
+				g_localStorage.error = EGL_NOT_INITIALIZED;
 
-					g_localStorage.error = EGL_BAD_PARAMETER;
+				return EGL_FALSE;
+			}
 
-					return EGL_FALSE;
-				}
+			EGLSyncImpl* walkerSync = walkerDpy->syncTable.lookup(sync);
+
+			if (!walkerSync || walkerSync->destroy || flags != 0)
+			{
+				g_localStorage.error = EGL_BAD_PARAMETER;
+
+				return EGL_FALSE;
+			}
+
+			if (g_localStorage.currentCtx == EGL_NO_CONTEXT || g_localStorage.currentDpy != walkerDpy)
+			{
+				g_localStorage.error = EGL_BAD_MATCH;
+
+				return EGL_FALSE;
+			}
 
-				walkerCtx = walkerCtx->next;
+			if (walkerSync->status == EGL_SIGNALED)
+			{
+				return EGL_TRUE;
 			}
 
-			g_localStorage.error = EGL_BAD_CONTEXT;
+			const GLSyncFunctions* gl = _eglInternalCanAccessFence(walkerSync) ? _eglInternalGetSyncFunctions() : 0;
 
-			return EGL_FALSE;
+			if (!gl)
+			{
+				g_localStorage.error = EGL_BAD_MATCH;
+
+				return EGL_FALSE;
+			}
+
+			// Only the command stream of the current context waits, the calling thread returns at once.
+			gl->waitSync(walkerSync->fence, 0, GL_TIMEOUT_IGNORED);
+
+			return EGL_TRUE;
 		}
 
 		walkerDpy = walkerDpy->next;
@@ -2538,7 +4621,7 @@ EGLBoolean _eglQueryContext (EGLDisplay dpy, EGLContext ctx, EGLint attribute, E
 	return EGL_FALSE;
 }
 
-const char *_eglQueryString(EGLDisplay dpy, EGLint name)
+EGLBoolean _eglGetSyncAttrib(EGLDisplay dpy, EGLSync sync, EGLint attribute, EGLAttrib* value)
 {
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
@@ -2553,55 +4636,130 @@ const char *_eglQueryString(EGLDisplay dpy, EGLint name)
 			{
 				g_localStorage.error = EGL_NOT_INITIALIZED;
 
-				return 0;
+				return EGL_FALSE;
 			}
 
-			switch (name)
+			EGLSyncImpl* walkerSync = walkerDpy->syncTable.lookup(sync);
+
+			if (!walkerSync || walkerSync->destroy)
 			{
-				case EGL_CLIENT_APIS:
-				{
-					return "EGL_OPENGL_API";
-				}
-				break;
-				case EGL_VENDOR:
+				g_localStorage.error = EGL_BAD_PARAMETER;
+
+				return EGL_FALSE;
+			}
+
+			if (!value)
+			{
+				g_localStorage.error = EGL_BAD_PARAMETER;
+
+				return EGL_FALSE;
+			}
+
+			switch (attribute)
+			{
+				case EGL_SYNC_TYPE:
 				{
-					return _EGL_VENDOR;
+					*value = walkerSync->type;
+
+					return EGL_TRUE;
 				}
 				break;
-				case EGL_VERSION:
+				case EGL_SYNC_STATUS:
 				{
-					return _EGL_VERSION;
+					if (walkerSync->status != EGL_SIGNALED && walkerSync->fence)
+					{
+						GLint glStatus = 0;
+
+						const GLSyncFunctions* gl = _eglInternalCanAccessFence(walkerSync) ? _eglInternalGetSyncFunctions() : 0;
+
+						// The fence only exists in its share group, so its status is unknown with no context of the group current.
+						if (!gl)
+						{
+							g_localStorage.error = EGL_BAD_MATCH;
+
+							return EGL_FALSE;
+						}
+
+						gl->getSynciv(walkerSync->fence, GL_SYNC_STATUS, 1, 0, &glStatus);
+
+						if (glStatus == GL_SIGNALED)
+						{
+							walkerSync->status = EGL_SIGNALED;
+						}
+					}
+
+					*value = walkerSync->status;
+
+					return EGL_TRUE;
 				}
 				break;
-				case EGL_EXTENSIONS:
+				case EGL_SYNC_CONDITION:
 				{
-					return "";
+					if (walkerSync->type == EGL_SYNC_FENCE)
+					{
+						*value = EGL_SYNC_PRIOR_COMMANDS_COMPLETE;
+
+						return EGL_TRUE;
+					}
 				}
 				break;
 			}
 
-			g_localStorage.error = EGL_BAD_PARAMETER;
+			g_localStorage.error = EGL_BAD_ATTRIBUTE;
 
-			return 0;
+			return EGL_FALSE;
 		}
 
-		walkerDpy = walkerDpy->next;
+		walkerDpy = walkerDpy->next;
+	}
+
+	g_localStorage.error = EGL_BAD_DISPLAY;
+
+	return EGL_FALSE;
+}
+
+//
+// Images
+//
+
+// Whether a context of the first share group can access the objects of the second one. Needs the display lock.
+static bool _eglInternalCanAccessImage(const EGLShareGroupImpl* ctxShareGroup, const EGLShareGroupImpl* imageShareGroup)
+{
+	if (ctxShareGroup == imageShareGroup)
+	{
+		return true;
 	}
 
-	g_localStorage.error = EGL_BAD_DISPLAY;
-
-	return 0;
+	return ctxShareGroup->displayShared && imageShareGroup->displayShared && ctxShareGroup->api == imageShareGroup->api && ctxShareGroup->noError == imageShareGroup->noError;
 }
 
-EGLBoolean _eglQuerySurface (EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint *value)
+// Returns EGL_FALSE for an unknown attribute.
+static EGLBoolean _eglInternalImageAttrib(EGLAttrib attribute, EGLAttrib value, EGLint* level)
 {
-	// TODO Implement querying a surface.
+	switch (attribute)
+	{
+		case EGL_GL_TEXTURE_LEVEL:
+			*level = (EGLint)value;
+		break;
+		case EGL_IMAGE_PRESERVED:
+			// The object of the image is bound, when the image is targeted, so the content is always preserved.
+		break;
+		default:
+			return EGL_FALSE;
+	}
 
-	return EGL_FALSE;
+	return EGL_TRUE;
 }
 
-EGLBoolean _eglSwapBuffers(EGLDisplay dpy, EGLSurface surface)
+static EGLImage _eglInternalCreateImage(EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, EGLint level, EGLBoolean badAttribute)
 {
+	if (badAttribute)
+	{
+		g_localStorage.error = EGL_BAD_PARAMETER;
+
+		return EGL_NO_IMAGE;
+	}
+
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
 	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
 
@@ -2615,31 +4773,100 @@ EGLBoolean _eglSwapBuffers(EGLDisplay dpy, EGLSurface surface)
 			{
 				g_localStorage.error = EGL_NOT_INITIALIZED;
 
-				return 0;
+				return EGL_NO_IMAGE;
+			}
+
+			EGLContextImpl* walkerCtx = walkerDpy->ctxTable.lookup(ctx);
+
+			if (!walkerCtx || walkerCtx->destroy)
+			{
+				g_localStorage.error = EGL_BAD_CONTEXT;
+
+				return EGL_NO_IMAGE;
+			}
+
+			if (target != EGL_GL_TEXTURE_2D && target != EGL_GL_RENDERBUFFER)
+			{
+				g_localStorage.error = EGL_BAD_PARAMETER;
+
+				return EGL_NO_IMAGE;
+			}
+
+			// A context, which never was current, has no objects yet.
+			if (!buffer || !walkerCtx->rootCtxList)
+			{
+				g_localStorage.error = EGL_BAD_PARAMETER;
+
+				return EGL_NO_IMAGE;
 			}
 
-			EGLSurfaceImpl* walkerSurface = walkerDpy->rootSurface;
+			// The whole object is bound, when the image is targeted, so only level 0 can be an image.
+			if (level != 0)
+			{
+				g_localStorage.error = EGL_BAD_MATCH;
+
+				return EGL_NO_IMAGE;
+			}
 
-			while (walkerSurface)
+			for (EGLImageImpl* walkerImage = walkerDpy->rootImage; walkerImage; walkerImage = walkerImage->next)
 			{
-				if ((EGLSurface)walkerSurface == surface)
+				if (!walkerImage->destroy && walkerImage->shareGroup == walkerCtx->shareGroup && walkerImage->target == target && walkerImage->buffer == buffer && walkerImage->level == level)
 				{
-					if (!walkerSurface->initialized || walkerSurface->destroy)
-					{
-						g_localStorage.error = EGL_BAD_SURFACE;
+					g_localStorage.error = EGL_BAD_ACCESS;
 
-						return EGL_FALSE;
-					}
+					return EGL_NO_IMAGE;
+				}
+			}
+
+			EGLImageImpl* newImage = (EGLImageImpl*)malloc(sizeof(EGLImageImpl));
+
+			if (!newImage)
+			{
+				g_localStorage.error = EGL_BAD_ALLOC;
 
-					return __swapBuffers(walkerDpy, walkerSurface);
+				return EGL_NO_IMAGE;
+			}
+
+			newImage->target = target;
+			newImage->buffer = buffer;
+			newImage->level = level;
+
+			// The object is checked, if the current context can access it. Otherwise its checks wait until the image is
+			// targeted, as no native context is made current here.
+			if (g_localStorage.currentDpy == walkerDpy && g_localStorage.currentCtx != EGL_NO_CONTEXT && _eglInternalCanAccessImage(g_localStorage.currentCtx->shareGroup, walkerCtx->shareGroup))
+			{
+				const GLImageFunctions* gl = _eglInternalGetImageFunctions();
+
+				const EGLint imageError = gl ? _eglInternalCheckImageSource(gl, newImage) : EGL_BAD_MATCH;
+
+				if (imageError != EGL_SUCCESS)
+				{
+					free(newImage);
+
+					g_localStorage.error = imageError;
+
+					return EGL_NO_IMAGE;
 				}
+			}
+
+			newImage->handle = walkerDpy->imageTable.insert(newImage);
+
+			if (!newImage->handle)
+			{
+				free(newImage);
+
+				g_localStorage.error = EGL_BAD_ALLOC;
 
-				walkerSurface = walkerSurface->next;
+				return EGL_NO_IMAGE;
 			}
 
-			g_localStorage.error = EGL_BAD_SURFACE;
+			newImage->destroy = EGL_FALSE;
+			newImage->shareGroup = walkerCtx->shareGroup;
+			newImage->shareGroup->refCount++;
 
-			return EGL_FALSE;
+			_eglInternalLink(&walkerDpy->rootImage, newImage);
+
+			return newImage->handle;
 		}
 
 		walkerDpy = walkerDpy->next;
@@ -2647,10 +4874,36 @@ EGLBoolean _eglSwapBuffers(EGLDisplay dpy, EGLSurface surface)
 
 	g_localStorage.error = EGL_BAD_DISPLAY;
 
-	return EGL_FALSE;
+	return EGL_NO_IMAGE;
 }
 
-EGLBoolean _eglTerminate(EGLDisplay dpy)
+EGLImage _eglCreateImage(EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLAttrib* attrib_list)
+{
+	EGLint level = 0;
+	EGLBoolean badAttribute = EGL_FALSE;
+
+	for (const EGLAttrib* walkerAttrib = attrib_list; walkerAttrib && walkerAttrib[0] != EGL_NONE && !badAttribute; walkerAttrib += 2)
+	{
+		badAttribute = !_eglInternalImageAttrib(walkerAttrib[0], walkerAttrib[1], &level);
+	}
+
+	return _eglInternalCreateImage(dpy, ctx, target, buffer, level, badAttribute);
+}
+
+EGLImage _eglCreateImageKHR(EGLDisplay dpy, EGLContext ctx, EGLenum target, EGLClientBuffer buffer, const EGLint* attrib_list)
+{
+	EGLint level = 0;
+	EGLBoolean badAttribute = EGL_FALSE;
+
+	for (const EGLint* walkerAttrib = attrib_list; walkerAttrib && walkerAttrib[0] != EGL_NONE && !badAttribute; walkerAttrib += 2)
+	{
+		badAttribute = !_eglInternalImageAttrib(walkerAttrib[0], walkerAttrib[1], &level);
+	}
+
+	return _eglInternalCreateImage(dpy, ctx, target, buffer, level, badAttribute);
+}
+
+EGLBoolean _eglDestroyImage(EGLDisplay dpy, EGLImage image)
 {
 	EGLBoolean success = EGL_FALSE;
 	{
@@ -2665,15 +4918,26 @@ EGLBoolean _eglTerminate(EGLDisplay dpy)
 
 				if (!walkerDpy->initialized || walkerDpy->destroy)
 				{
-					g_localStorage.error = EGL_BAD_DISPLAY;
+					g_localStorage.error = EGL_NOT_INITIALIZED;
+
+					return EGL_FALSE;
+				}
+
+				EGLImageImpl* walkerImage = walkerDpy->imageTable.lookup(image);
+
+				if (!walkerImage || walkerImage->destroy)
+				{
+					g_localStorage.error = EGL_BAD_PARAMETER;
 
 					return EGL_FALSE;
 				}
 
-				walkerDpy->initialized = EGL_FALSE;
-				walkerDpy->destroy = EGL_TRUE;
+				walkerImage->destroy = EGL_TRUE;
+
+				_eglInternalRetire(&walkerDpy->rootImage, &walkerDpy->retiredImages, walkerImage);
 
 				success = EGL_TRUE;
+				break;
 			}
 
 			walkerDpy = walkerDpy->next;
@@ -2681,136 +4945,91 @@ EGLBoolean _eglTerminate(EGLDisplay dpy)
 	}
 
 	if (success)
+	{
 		_eglInternalCleanup();
 
+		return EGL_TRUE;
+	}
+
 	g_localStorage.error = EGL_BAD_DISPLAY;
 
 	return EGL_FALSE;
 }
 
-
-
-EGLBoolean _eglWaitNative(EGLint engine)
+// Binds the texture or renderbuffer of the image to target in the current context, as EGLImages are not imported by the
+// native driver. The object is shared, so later changes of either side are seen by the other, but the bound name becomes
+// the one of the image. Without access to the object, the binding is kept.
+static void _eglInternalImageTarget(EGLenum imageTarget, GLenum target, void* image)
 {
-	if (engine != EGL_CORE_NATIVE_ENGINE)
-	{
-		g_localStorage.error = EGL_BAD_PARAMETER;
+	EGLDisplayImpl* walkerDpy = g_localStorage.currentDpy;
+	const EGLContextImpl* currentCtx = g_localStorage.currentCtx;
 
-		return EGL_FALSE;
+	// Without a current context, GL commands have no effect and no error.
+	if (!walkerDpy || currentCtx == EGL_NO_CONTEXT)
+	{
+		return;
 	}
 
-	auto _rl = g_globalStorage.placeRootDpy_readlock();
-	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+	const GLImageFunctions* gl = _eglInternalGetImageFunctions();
 
-	while (walkerDpy)
+	if (!gl || target != (imageTarget == EGL_GL_TEXTURE_2D ? GL_TEXTURE_2D : GL_RENDERBUFFER))
 	{
-		if (walkerDpy->currentCtx == g_localStorage.currentCtx)
-		{
-			guard_t _{ walkerDpy->mutex };
-
-			if (walkerDpy->currentDraw && (!walkerDpy->currentDraw->initialized || walkerDpy->currentDraw->destroy))
-			{
-				g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
-
-				return EGL_FALSE;
-			}
-
-			if (walkerDpy->currentRead && (!walkerDpy->currentRead->initialized || walkerDpy->currentRead->destroy))
-			{
-				g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
-
-				return EGL_FALSE;
-			}
-
-			break;
-		}
-
-		walkerDpy = walkerDpy->next;
+		return;
 	}
 
-	if (g_localStorage.api == EGL_OPENGL_API)
+	GLuint name = 0;
 	{
-		glFinish();
-	}
+		guard_t _{ walkerDpy->mutex };
 
-	return EGL_TRUE;
-}
+		EGLImageImpl* walkerImage = walkerDpy->imageTable.lookup(image);
 
-//
-// EGL_VERSION_1_1
-//
+		if (!walkerImage || walkerImage->destroy || walkerImage->target != imageTarget || !_eglInternalCanAccessImage(currentCtx->shareGroup, walkerImage->shareGroup))
+		{
+			return;
+		}
 
-EGLBoolean _eglSwapInterval(EGLDisplay dpy, EGLint interval)
-{
-	auto _rl = g_globalStorage.placeRootDpy_readlock();
-	EGLDisplayImpl* walkerDpy = g_globalStorage.rootDpy;
+		name = (GLuint)(uintptr_t)walkerImage->buffer;
+	}
 
-	while (walkerDpy)
+	// The object may have been deleted since the image was created.
+	if (imageTarget == EGL_GL_RENDERBUFFER)
 	{
-		if ((EGLDisplay)walkerDpy == dpy)
+		if (gl->isRenderbuffer(name))
 		{
-			guard_t _{ walkerDpy->mutex };
-
-			if (!walkerDpy->initialized || walkerDpy->destroy)
-			{
-				g_localStorage.error = EGL_BAD_DISPLAY;
-
-				return EGL_FALSE;
-			}
-
-			if (walkerDpy->currentDraw == EGL_NO_SURFACE || walkerDpy->currentRead == EGL_NO_SURFACE)
-			{
-				g_localStorage.error = EGL_BAD_SURFACE;
-
-				return EGL_FALSE;
-			}
-
-			if (walkerDpy->currentCtx == EGL_NO_CONTEXT)
-			{
-				g_localStorage.error = EGL_BAD_CONTEXT;
-
-				return EGL_FALSE;
-			}
-
-			return __swapInterval(walkerDpy, interval);
+			gl->bindRenderbuffer(GL_RENDERBUFFER, name);
 		}
-
-		walkerDpy = walkerDpy->next;
 	}
-
-	g_localStorage.error = EGL_BAD_DISPLAY;
-
-	return EGL_FALSE;
-}
-
-//
-// EGL_VERSION_1_2
-//
-
-EGLBoolean _eglBindAPI(EGLenum api)
-{
-	if (api == EGL_OPENGL_API || api == EGL_OPENGL_ES_API)
+	else if (gl->isTexture(name))
 	{
-		g_localStorage.api = api;
-
-		return EGL_TRUE;
+		gl->bindTexture(GL_TEXTURE_2D, name);
 	}
+}
 
-	g_localStorage.error = EGL_BAD_PARAMETER;
-
-	return EGL_FALSE;
+void _eglImageTargetTexture2D(GLenum target, void* image)
+{
+	_eglInternalImageTarget(EGL_GL_TEXTURE_2D, target, image);
 }
 
-EGLenum _eglQueryAPI(void)
+void _eglImageTargetRenderbufferStorage(GLenum target, void* image)
 {
-	return g_localStorage.api;
+	_eglInternalImageTarget(EGL_GL_RENDERBUFFER, target, image);
 }
 
-EGLBoolean _eglWaitClient(void)
+//
+// non-standard stuff
+//
+
+//
+// Diagnostics
+//
+
+EGLBoolean _eglQueryDisplayDiagnostic(EGLDisplay dpy, EGLint name, EGLAttrib* value)
 {
-	if (g_localStorage.currentCtx == EGL_NO_CONTEXT)
+	if (!value)
 	{
-		return EGL_TRUE;
+		g_localStorage.error = EGL_BAD_PARAMETER;
+
+		return EGL_FALSE;
 	}
 
 	auto _rl = g_globalStorage.placeRootDpy_readlock();
@@ -2818,64 +5037,47 @@ EGLBoolean _eglWaitClient(void)
 
 	while (walkerDpy)
 	{
-		if (walkerDpy->currentCtx == g_localStorage.currentCtx)
+		if ((EGLDisplay)walkerDpy == dpy)
 		{
 			guard_t _{ walkerDpy->mutex };
 
-			if (!walkerDpy->initialized || walkerDpy->destroy)
-			{
-				return EGL_FALSE;
-			}
-
-			if (walkerDpy->currentDraw && (!walkerDpy->currentDraw->initialized || walkerDpy->currentDraw->destroy))
-			{
-				g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
-
-				return EGL_FALSE;
-			}
-
-			if (walkerDpy->currentRead && (!walkerDpy->currentRead->initialized || walkerDpy->currentRead->destroy))
+			switch (name)
 			{
-				g_localStorage.error = EGL_BAD_CURRENT_SURFACE;
+				case EGL_DIAGNOSTIC_CHOOSE_CONFIG_CACHE_HITS:
+				{
+					*value = (EGLAttrib)walkerDpy->chooseConfigCacheHits;
+				}
+				break;
+				case EGL_DIAGNOSTIC_CHOOSE_CONFIG_CACHE_MISSES:
+				{
+					*value = (EGLAttrib)walkerDpy->chooseConfigCacheMisses;
+				}
+				break;
+				case EGL_DIAGNOSTIC_MAKE_CURRENT_ELIDED:
+				{
+					*value = (EGLAttrib)walkerDpy->makeCurrentElided.load(std::memory_order_relaxed);
+				}
+				break;
+				default:
+				{
+					g_localStorage.error = EGL_BAD_ATTRIBUTE;
 
-				return EGL_FALSE;
+					return EGL_FALSE;
+				}
+				break;
 			}
 
-			break;
+			return EGL_TRUE;
 		}
 
 		walkerDpy = walkerDpy->next;
 	}
 
-	if (g_localStorage.api == EGL_OPENGL_API)
-	{
-		glFinish();
-	}
-
-	return EGL_TRUE;
-}
-
-//
-// EGL_VERSION_1_3
-//
-
-//
-// EGL_VERSION_1_4
-//
+	g_localStorage.error = EGL_BAD_DISPLAY;
 
-EGLContext _eglGetCurrentContext(void)
-{
-	return g_localStorage.currentCtx;
+	return EGL_FALSE;
 }
 
-//
-// EGL_VERSION_1_5
-//
-
-//
-// non-standard stuff
-//
-
 /*
 EGLBoolean _eglGetPlatformDependentHandles(void* out, EGLDisplay dpy, EGLSurface surface, EGLContext ctx)
 {
@@ -31,9 +31,16 @@
 
 #define _EGL_VERSION "1.5 Version 0.3.3"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <array>
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <new>
+#include <string>
+#include <vector>
 
 #if defined(_WIN32) || defined(__VC32__) && !defined(__CYGWIN__) && !defined(__SCITECH_SNAP__) /* Win32 and WinCE */
 
@@ -51,6 +58,10 @@
 
 #define CONTEXT_ATTRIB_LIST_SIZE 13
 
+typedef struct _NativeConfigContainer {
+
+} NativeConfigContainer;
+
 typedef struct _NativeSurfaceContainer {
 
 	HDC hdc;
@@ -81,6 +92,10 @@ typedef HPBUFFERARB NativePbufferType;
 
 #define CONTEXT_ATTRIB_LIST_SIZE 1
 
+typedef struct _NativeConfigContainer {
+
+} NativeConfigContainer;
+
 typedef struct _NativeSurfaceContainer {
 
 } NativeSurfaceContainer;
@@ -105,10 +120,24 @@ typedef void* NativePbufferType;
 #else
 #include <GL/glx.h>
 #endif  // EGL_NO_GLEW
-#define CONTEXT_ATTRIB_LIST_SIZE 11
+#define CONTEXT_ATTRIB_LIST_SIZE 15
+
+typedef struct _NativeConfigContainer {
+
+	GLXFBConfig config;
+
+	Bool srgbCapable;
+
+	// sRGB capable variant of config, resolved on first use under the display lock.
+	GLXFBConfig srgbConfig;
+
+} NativeConfigContainer;
 
 typedef struct _NativeSurfaceContainer {
 
+	// Connection, the drawable and the configuration belong to.
+	Display* display;
+
 	GLXDrawable drawable;
 
 	GLXFBConfig config;
@@ -117,6 +146,12 @@ typedef struct _NativeSurfaceContainer {
 
 typedef struct _NativeContextContainer {
 
+	// Connection, the context was created on.
+	Display* display;
+
+	// Frame buffer configuration, the context was created with.
+	GLXFBConfig config;
+
 	GLXContext ctx;
 
 } NativeContextContainer;
@@ -141,6 +176,133 @@ typedef GLXPbuffer NativePbufferType;
 
 //
 
+// Handles given out to the application are not pointers, but encode a slot index into the owning display's
+// handle table together with the generation of that slot. Lookups are O(1) and a handle of a freed object
+// is rejected, even if its slot has been reused in the meantime.
+
+#define EGL_HANDLE_TYPE_BITS 3
+#define EGL_HANDLE_INDEX_BITS 20
+
+#define EGL_HANDLE_TYPE_CONFIG 1
+#define EGL_HANDLE_TYPE_CONTEXT 2
+#define EGL_HANDLE_TYPE_SURFACE 3
+#define EGL_HANDLE_TYPE_SYNC 4
+#define EGL_HANDLE_TYPE_IMAGE 5
+
+template<typename T, uintptr_t TYPE>
+struct EGLHandleTable
+{
+	static const uintptr_t TYPE_MASK = ((uintptr_t)1 << EGL_HANDLE_TYPE_BITS) - 1;
+	static const uintptr_t INDEX_MASK = ((uintptr_t)1 << EGL_HANDLE_INDEX_BITS) - 1;
+	static const uintptr_t GENERATION_SHIFT = EGL_HANDLE_TYPE_BITS + EGL_HANDLE_INDEX_BITS;
+	static const uintptr_t GENERATION_MASK = ~(uintptr_t)0 >> GENERATION_SHIFT;
+
+	struct Slot
+	{
+		T* object;
+		uintptr_t generation;
+	};
+
+	// Returns 0, if the table is full or out of memory.
+	void* insert(T* object)
+	{
+		uintptr_t index;
+
+		if (!freeSlots.empty())
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			if (slots.size() > INDEX_MASK)
+			{
+				return 0;
+			}
+
+			index = slots.size();
+
+			Slot slot = { 0, 1 };
+			try
+			{
+				slots.push_back(slot);
+				freeSlots.reserve(slots.size());
+			}
+			catch (const std::bad_alloc&)
+			{
+				return 0;
+			}
+		}
+
+		slots[index].object = object;
+
+		return (void*)((slots[index].generation << GENERATION_SHIFT) | (index << EGL_HANDLE_TYPE_BITS) | TYPE);
+	}
+
+	T* lookup(const void* handle) const
+	{
+		const uintptr_t value = (uintptr_t)handle;
+		const uintptr_t index = (value >> EGL_HANDLE_TYPE_BITS) & INDEX_MASK;
+
+		if ((value & TYPE_MASK) != TYPE || index >= slots.size())
+		{
+			return 0;
+		}
+
+		const Slot& slot = slots[index];
+
+		if (slot.generation != (value >> GENERATION_SHIFT))
+		{
+			return 0;
+		}
+
+		return slot.object;
+	}
+
+	void remove(const void* handle)
+	{
+		const uintptr_t index = ((uintptr_t)handle >> EGL_HANDLE_TYPE_BITS) & INDEX_MASK;
+
+		if (!lookup(handle))
+		{
+			return;
+		}
+
+		Slot& slot = slots[index];
+
+		slot.object = 0;
+
+		// Generation 0 is never handed out, so a wrapped around generation does not match a zeroed handle.
+		slot.generation = (slot.generation + 1) & GENERATION_MASK;
+		if (!slot.generation)
+		{
+			slot.generation = 1;
+		}
+
+		freeSlots.push_back((uint32_t)index);
+	}
+
+	void clear()
+	{
+		for (size_t index = 0; index < slots.size(); index++)
+		{
+			if (slots[index].object)
+			{
+				remove(handle(index));
+			}
+		}
+	}
+
+private:
+	const void* handle(uintptr_t index) const
+	{
+		return (const void*)((slots[index].generation << GENERATION_SHIFT) | (index << EGL_HANDLE_TYPE_BITS) | TYPE);
+	}
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+};
+
 typedef struct _EGLConfigImpl
 {
 
@@ -245,6 +407,10 @@ typedef struct _EGLConfigImpl
 
 	// Own data.
 
+	EGLConfig handle;
+
+	NativeConfigContainer nativeConfigContainer;
+
 	EGLint drawToWindow;
 	EGLint drawToPixmap;
 	EGLint drawToPBuffer;
@@ -258,7 +424,10 @@ typedef struct _EGLSurfaceImpl
 {
 
 	EGLBoolean initialized;
-	EGLBoolean destroy;
+	// Read without the display lock by a thread the surface is bound to.
+	std::atomic<EGLBoolean> destroy;
+
+	EGLSurface handle;
 
 	EGLBoolean drawToWindow;
 	EGLBoolean drawToPixmap;
@@ -273,6 +442,10 @@ typedef struct _EGLSurfaceImpl
 
 	NativeSurfaceContainer nativeSurfaceContainer;
 
+	// Number of draw and read bindings of all threads and of native calls in progress.
+	std::atomic<EGLint> currentCount;
+
+	struct _EGLSurfaceImpl* prev;
 	struct _EGLSurfaceImpl* next;
 
 } EGLSurfaceImpl;
@@ -280,7 +453,8 @@ typedef struct _EGLSurfaceImpl
 typedef struct _EGLContextListImpl
 {
 
-	EGLSurfaceImpl* surface;
+	// Surfaces created with this configuration share the native context.
+	EGLint configId;
 
 	NativeContextContainer nativeContextContainer;
 
@@ -288,42 +462,234 @@ typedef struct _EGLContextListImpl
 
 } EGLContextListImpl;
 
+typedef struct _EGLShareGroupImpl
+{
+
+	// Contexts, syncs and images using the share group. Changed under the display lock.
+	EGLint refCount;
+
+	// Client API and EGL_CONTEXT_OPENGL_NO_ERROR_KHR of the first context of the group.
+	EGLenum api;
+	EGLBoolean noError;
+
+	// Whether the native contexts of the group share with the display share context of its API, see EGLDisplayImpl.
+	EGLBoolean displayShared;
+
+} EGLShareGroupImpl;
+
 typedef struct _EGLContextImpl
 {
 
 	EGLBoolean initialized;
-	EGLBoolean destroy;
+	// Read without the display lock by the thread the context is bound to.
+	std::atomic<EGLBoolean> destroy;
+
+	EGLContext handle;
 
 	EGLint configId;
 
 	struct _EGLContextImpl* sharedCtx;
 
+	EGLShareGroupImpl* shareGroup;
+
 	EGLContextListImpl* rootCtxList;
 
 	EGLint attribList[CONTEXT_ATTRIB_LIST_SIZE];
 
+	// EGL_CONTEXT_OPENGL_NO_ERROR_KHR. Only contexts with the same value can share objects.
+	EGLBoolean noError;
+
+	// Number of threads, the context is current to. At most one.
+	std::atomic<EGLint> currentCount;
+
+	// Number of native contexts being created from this context or sharing with it, without the display lock.
+	// Needs the display lock.
+	EGLint pendingCount;
+
+	struct _EGLContextImpl* prev;
 	struct _EGLContextImpl* next;
 
 } EGLContextImpl;
 
+typedef struct _EGLSyncImpl
+{
+
+	EGLBoolean destroy;
+
+	EGLSync handle;
+
+	EGLenum type;
+
+	// EGL_SIGNALED or EGL_UNSIGNALED. A fence only changes to signaled.
+	std::atomic<EGLint> status;
+
+	// GL fence object of the share group. The reference keeps the group alive, after its contexts are gone.
+	void* fence;
+	EGLShareGroupImpl* shareGroup;
+
+	// Number of waits in progress outside of the display lock.
+	std::atomic<EGLint> waitCount;
+
+	struct _EGLSyncImpl* prev;
+	struct _EGLSyncImpl* next;
+
+} EGLSyncImpl;
+
+typedef struct _EGLImageImpl
+{
+
+	EGLBoolean destroy;
+
+	EGLImage handle;
+
+	// EGL_GL_TEXTURE_2D or EGL_GL_RENDERBUFFER.
+	EGLenum target;
+
+	// Texture or renderbuffer name, as passed to eglCreateImage, and the share group of the context it belongs to.
+	EGLClientBuffer buffer;
+	EGLShareGroupImpl* shareGroup;
+
+	// EGL_GL_TEXTURE_LEVEL.
+	EGLint level;
+
+	struct _EGLImageImpl* prev;
+	struct _EGLImageImpl* next;
+
+} EGLImageImpl;
+
+// Attributes compared by eglChooseConfig, in the order of the configuration store columns and of the cache key.
+enum EGLConfigColumn
+{
+	EGL_CONFIG_COLUMN_ALPHA_MASK_SIZE,
+	EGL_CONFIG_COLUMN_ALPHA_SIZE,
+	EGL_CONFIG_COLUMN_BIND_TO_TEXTURE_RGB,
+	EGL_CONFIG_COLUMN_BIND_TO_TEXTURE_RGBA,
+	EGL_CONFIG_COLUMN_BLUE_SIZE,
+	EGL_CONFIG_COLUMN_BUFFER_SIZE,
+	EGL_CONFIG_COLUMN_COLOR_BUFFER_TYPE,
+	EGL_CONFIG_COLUMN_CONFIG_CAVEAT,
+	EGL_CONFIG_COLUMN_CONFIG_ID,
+	EGL_CONFIG_COLUMN_CONFORMANT,
+	EGL_CONFIG_COLUMN_DEPTH_SIZE,
+	EGL_CONFIG_COLUMN_GREEN_SIZE,
+	EGL_CONFIG_COLUMN_LEVEL,
+	EGL_CONFIG_COLUMN_LUMINANCE_SIZE,
+	EGL_CONFIG_COLUMN_MATCH_NATIVE_PIXMAP,
+	EGL_CONFIG_COLUMN_NATIVE_RENDERABLE,
+	EGL_CONFIG_COLUMN_MAX_SWAP_INTERVAL,
+	EGL_CONFIG_COLUMN_MIN_SWAP_INTERVAL,
+	EGL_CONFIG_COLUMN_RED_SIZE,
+	EGL_CONFIG_COLUMN_SAMPLE_BUFFERS,
+	EGL_CONFIG_COLUMN_SAMPLES,
+	EGL_CONFIG_COLUMN_STENCIL_SIZE,
+	EGL_CONFIG_COLUMN_RENDERABLE_TYPE,
+	EGL_CONFIG_COLUMN_SURFACE_TYPE,
+	EGL_CONFIG_COLUMN_TRANSPARENT_TYPE,
+	EGL_CONFIG_COLUMN_TRANSPARENT_RED_VALUE,
+	EGL_CONFIG_COLUMN_TRANSPARENT_GREEN_VALUE,
+	EGL_CONFIG_COLUMN_TRANSPARENT_BLUE_VALUE,
+	EGL_CONFIG_COLUMN_DOUBLE_BUFFER,
+
+	EGL_CONFIG_COLUMN_COUNT
+};
+
+// Selection criteria of eglChooseConfig, after the defaults have been applied.
+typedef std::array<EGLint, EGL_CONFIG_COLUMN_COUNT> EGLChooseConfigKey;
+
+// Client API, followed by the attribute pairs of eglCreateContext apart from the version, sorted by attribute.
+typedef std::vector<EGLint> EGLVersionKey;
+
+// Highest context version known to work and lowest known to fail. Zero, while not known.
+typedef struct _EGLVersionBounds
+{
+
+	EGLint supported[2];
+	EGLint unsupported[2];
+
+} EGLVersionBounds;
+
+// Number of configurations compared at once. The columns are padded to a multiple of it.
+#define EGL_CONFIG_STORE_LANES 8
+
+// Structure of arrays copy of the configuration list, so eglChooseConfig can filter one attribute at a time.
+typedef struct _EGLConfigStore
+{
+	EGLint count;
+	EGLint paddedCount;
+
+	std::vector<EGLConfigImpl*> configs;
+
+	// Column c starts at c * paddedCount.
+	std::vector<EGLint> columns;
+
+	// Smallest value per column, to skip minimum criteria every configuration meets.
+	EGLint columnMin[EGL_CONFIG_COLUMN_COUNT];
+
+	// Per configuration filter result, all bits set for a match. Reused between calls.
+	std::vector<EGLint> matchMask;
+
+	// Matching configurations of the last filter run. Sized for all configurations, reused between calls.
+	std::vector<EGLConfigImpl*> matches;
+} EGLConfigStore;
+
 typedef struct _EGLDisplayImpl
 {
 	std::mutex mutex;
 
-	EGLBoolean initialized;
-	EGLBoolean destroy;
+	// Read without the lock by threads with a binding on the display.
+	std::atomic<EGLBoolean> initialized;
+	std::atomic<EGLBoolean> destroy;
 
 	EGLNativeDisplayType display_id;
 
 	EGLSurfaceImpl* rootSurface;
 	EGLContextImpl* rootCtx;
 	EGLConfigImpl* rootConfig;
+	EGLSyncImpl* rootSync;
+	EGLImageImpl* rootImage;
 
-	EGLSurfaceImpl* currentDraw;
-	EGLSurfaceImpl* currentRead;
-	EGLContextImpl* currentCtx;
+	EGLHandleTable<EGLSurfaceImpl, EGL_HANDLE_TYPE_SURFACE> surfaceTable;
+	EGLHandleTable<EGLContextImpl, EGL_HANDLE_TYPE_CONTEXT> ctxTable;
+	EGLHandleTable<EGLConfigImpl, EGL_HANDLE_TYPE_CONFIG> configTable;
+	EGLHandleTable<EGLSyncImpl, EGL_HANDLE_TYPE_SYNC> syncTable;
+	EGLHandleTable<EGLImageImpl, EGL_HANDLE_TYPE_IMAGE> imageTable;
+
+	// Hidden native contexts, one per client API and EGL_CONTEXT_OPENGL_NO_ERROR_KHR. The first native context of a
+	// share group shares with the one of its API, so images are accessible across share groups. Deleted with the display.
+	std::map<std::pair<EGLenum, EGLBoolean>, NativeContextContainer> shareCtxs;
+
+	// Destroyed objects, moved from the lists above. Reclaimed by cleanup, once no longer in use.
+	EGLSurfaceImpl* retiredSurfaces;
+	EGLContextImpl* retiredCtxs;
+	EGLSyncImpl* retiredSyncs;
+	EGLImageImpl* retiredImages;
+
+	EGLConfigStore configStore;
+
+	// Known context versions, per API, profile and flags, as these change the supported versions. Probed on demand.
+	std::map<EGLVersionKey, EGLVersionBounds> versionBounds;
+
+	// Sorted results of eglChooseConfig. Cleared on eglTerminate.
+	std::map<EGLChooseConfigKey, std::vector<EGLConfigImpl*>> chooseConfigCache;
+	uint64_t chooseConfigCacheHits;
+	uint64_t chooseConfigCacheMisses;
 
-	struct _EGLDisplayImpl* next;
+	// Redundant eglMakeCurrent calls. Counted without the display lock.
+	std::atomic<uint64_t> makeCurrentElided;
+
+	// EGL_EXTENSIONS, built on eglInitialize.
+	std::string extensions;
+
+	// EGL_KHR_context_flush_control and EGL_KHR_create_context_no_error, as found on eglInitialize.
+	EGLBoolean contextFlushControl;
+	EGLBoolean contextNoError;
+
+	// Number of threads with a current context on this display and of native calls in progress. The current objects
+	// itself are stored per thread.
+	std::atomic<EGLint> currentCount;
+
+	// Read without locks, see GlobalStorage.
+	std::atomic<struct _EGLDisplayImpl*> next;
 
 } EGLDisplayImpl;
 
@@ -334,6 +700,11 @@ typedef struct _LocalStorage
 	EGLenum api;
 
 	EGLContextImpl* currentCtx;
+
+	// Current bindings of this thread, so queries need no display lookup.
+	EGLDisplayImpl* currentDpy;
+	EGLSurfaceImpl* currentDraw;
+	EGLSurfaceImpl* currentRead;
 } LocalStorage;
 
 //
@@ -347,19 +718,21 @@ void _eglInternalSetDefaultConfig(EGLConfigImpl* config);
 
 //
 
-EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer, EGLint* GL_max_supported, EGLint* ES_max_supported);
+EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer);
 
 EGLBoolean __internalTerminate(NativeLocalStorageContainer* nativeLocalStorageContainer);
 
 EGLBoolean __deleteContext(const EGLDisplayImpl* walkerDpy, const NativeContextContainer* nativeContextContainer);
 
-EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error);
+EGLBoolean __probeContextVersion(const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, const NativeLocalStorageContainer* nativeLocalStorageContainer, const EGLint* attribList, EGLint major, EGLint minor);
+
+EGLBoolean __processAttribList(const EGLDisplayImpl* walkerDpy, EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error);
 
-EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error);
+EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error);
 
-EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error);
+EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error);
 
-EGLBoolean __destroySurface(EGLNativeDisplayType dpy, const EGLSurfaceImpl* surface);
+EGLBoolean __destroySurface(const EGLSurfaceImpl* surface);
 
 __eglMustCastToProperFunctionPointerType __getProcAddress(const char *procname);
 
@@ -367,11 +740,19 @@ EGLBoolean __initialize(EGLDisplayImpl* walkerDpy, const NativeLocalStorageConta
 
 EGLBoolean __createContext(NativeContextContainer* nativeContextContainer, const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* sharedNativeContextContainer, const EGLint* attribList);
 
-EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* nativeContextContainer);
+EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* drawSurfaceContainer, const NativeSurfaceContainer* readSurfaceContainer, const NativeContextContainer* nativeContextContainer);
+
+EGLBoolean __isCompatibleContext(const NativeContextContainer* nativeContextContainer, const NativeSurfaceContainer* nativeSurfaceContainer, EGLBoolean exactConfig);
+
+EGLBoolean __surfacelessSurface(NativeSurfaceContainer* nativeSurfaceContainer, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig);
+
+EGLBoolean __hasExtension(const EGLDisplayImpl* walkerDpy, const char* extension);
 
 EGLBoolean __swapBuffers(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface);
 
-EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, EGLint interval);
+EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface, EGLint interval);
+
+EGLBoolean __waitNative(const EGLDisplayImpl* walkerDpy);
 
 EGLBoolean __getPlatformDependentHandles(void* out, const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* nativeContextContainer);
 
@@ -6,7 +6,7 @@ typedef void(*__PFN_glFinish)();
 __PFN_glFinish glFinish_PTR = NULL;
 #endif
 
-EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer, EGLint* GL_max_supported, EGLint* ES_max_supported)
+EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer)
 {
     return EGL_FALSE;
 }
@@ -21,22 +21,27 @@ EGLBoolean __deleteContext(const EGLDisplayImpl* walkerDpy, const NativeContextC
     return EGL_FALSE;
 }
 
-EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error)
+EGLBoolean __probeContextVersion(const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, const NativeLocalStorageContainer* nativeLocalStorageContainer, const EGLint* attribList, EGLint major, EGLint minor)
 {
     return EGL_FALSE;
 }
 
-EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error)
+EGLBoolean __processAttribList(const EGLDisplayImpl* walkerDpy, EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error)
 {
     return EGL_FALSE;
 }
 
-EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error)
+EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error)
 {
     return EGL_FALSE;
 }
 
-EGLBoolean __destroySurface(EGLNativeDisplayType dpy, const EGLSurfaceImpl* surface)
+EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error)
+{
+    return EGL_FALSE;
+}
+
+EGLBoolean __destroySurface(const EGLSurfaceImpl* surface)
 {
     return EGL_FALSE;
 }
@@ -56,7 +61,22 @@ EGLBoolean __createContext(NativeContextContainer* nativeContextContainer, const
     return EGL_FALSE;
 }
 
-EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* nativeContextContainer)
+EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* drawSurfaceContainer, const NativeSurfaceContainer* readSurfaceContainer, const NativeContextContainer* nativeContextContainer)
+{
+    return EGL_FALSE;
+}
+
+EGLBoolean __isCompatibleContext(const NativeContextContainer* nativeContextContainer, const NativeSurfaceContainer* nativeSurfaceContainer, EGLBoolean exactConfig)
+{
+    return EGL_TRUE;
+}
+
+EGLBoolean __surfacelessSurface(NativeSurfaceContainer* nativeSurfaceContainer, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig)
+{
+    return EGL_FALSE;
+}
+
+EGLBoolean __hasExtension(const EGLDisplayImpl* walkerDpy, const char* extension)
 {
     return EGL_FALSE;
 }
@@ -66,7 +86,12 @@ EGLBoolean __swapBuffers(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl*
     return EGL_FALSE;
 }
 
-EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, EGLint interval)
+EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface, EGLint interval)
+{
+    return EGL_FALSE;
+}
+
+EGLBoolean __waitNative(const EGLDisplayImpl* walkerDpy)
 {
     return EGL_FALSE;
 }
@@ -55,6 +55,8 @@ PFNWGLCREATEPBUFFERARBPROC wglCreatePbufferARB = NULL;
 PFNWGLGETPBUFFERDCARBPROC wglGetPbufferDCARB = NULL;
 PFNWGLRELEASEPBUFFERDCARBPROC wglReleasePbufferDCARB = NULL;
 PFNWGLDESTROYPBUFFERARBPROC wglDestroyPbufferARB = NULL;
+
+PFNWGLMAKECONTEXTCURRENTARBPROC wglMakeContextCurrentARB = NULL;
 #endif
 
 
@@ -63,7 +65,7 @@ static LRESULT CALLBACK __DummyWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPAR
      return DefWindowProc(hwnd, uMsg, wParam, lParam);
 }
 
-EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer, EGLint* GL_max_supported, EGLint* ES_max_supported)
+EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer)
 {
 	if (!nativeLocalStorageContainer)
 	{
@@ -215,71 +217,11 @@ EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContain
 	wglReleasePbufferDCARB = (PFNWGLRELEASEPBUFFERDCARBPROC)__getProcAddress("wglReleasePbufferDCARB");
 	wglDestroyPbufferARB = (PFNWGLDESTROYPBUFFERARBPROC)__getProcAddress("wglDestroyPbufferARB");
 
+	wglMakeContextCurrentARB = (PFNWGLMAKECONTEXTCURRENTARBPROC)__getProcAddress("wglMakeContextCurrentARB");
+
 	wglMakeCurrent_PTR(NULL, NULL);
 #endif
 
-	EGLint attrib_list[] = {
-		WGL_CONTEXT_MAJOR_VERSION_ARB, 1,
-		WGL_CONTEXT_MINOR_VERSION_ARB, 0,
-		WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
-		0
-	};
-
-	HGLRC testctx = NULL;
-	EGLint GL_major = 4, GL_minor = 6;
-	for (; GL_major >= 1 && !testctx; --GL_major)
-	{
-		for (; GL_minor >= 0 && !testctx; --GL_minor)
-		{
-			attrib_list[1] = GL_major;
-			attrib_list[3] = GL_minor;
-			testctx = wglCreateContextAttribsARB(nativeLocalStorageContainer->hdc, NULL, attrib_list);
-		}
-	}
-	++GL_major;
-	++GL_minor;
-
-	if (testctx)
-	{
-		wglDeleteContext_PTR(testctx);
-		testctx = NULL;
-	}
-	else
-	{
-		GL_major = 0;
-		GL_minor = 0;
-	}
-	GL_max_supported[0] = GL_major;
-	GL_max_supported[1] = GL_minor;
-
-
-	attrib_list[5] = WGL_CONTEXT_ES_PROFILE_BIT_EXT;
-	EGLint ES_major = 3, ES_minor = 2;
-	for (; ES_major >= 1 && !testctx; --ES_major)
-	{
-		for (; ES_minor >= 0 && !testctx; --ES_minor)
-		{
-			attrib_list[1] = ES_major;
-			attrib_list[3] = ES_minor;
-			testctx = wglCreateContextAttribsARB(nativeLocalStorageContainer->hdc, NULL, attrib_list);
-		}
-	}
-	++ES_major;
-	++ES_minor;
-
-	if (testctx)
-	{
-		wglDeleteContext_PTR(testctx);
-		testctx = NULL;
-	}
-	else
-	{
-		ES_major = 0;
-		ES_minor = 0;
-	}
-	ES_max_supported[0] = ES_major;
-	ES_max_supported[1] = ES_minor;
-
 	return EGL_TRUE;
 }
 
@@ -327,7 +269,32 @@ EGLBoolean __deleteContext(const EGLDisplayImpl* walkerDpy, const NativeContextC
 	return wglDeleteContext_PTR(nativeContextContainer->ctx);
 }
 
-EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error)
+EGLBoolean __probeContextVersion(const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, const NativeLocalStorageContainer* nativeLocalStorageContainer, const EGLint* attribList, EGLint major, EGLint minor)
+{
+	if (!nativeLocalStorageContainer || !nativeLocalStorageContainer->hdc || !attribList || !wglCreateContextAttribsARB)
+	{
+		return EGL_FALSE;
+	}
+
+	// The attributes of the context, with the version in front as laid out by __processAttribList.
+	EGLint attrib_list[CONTEXT_ATTRIB_LIST_SIZE];
+	memcpy(attrib_list, attribList, sizeof(attrib_list));
+	attrib_list[1] = major;
+	attrib_list[3] = minor;
+
+	HGLRC testctx = wglCreateContextAttribsARB(nativeLocalStorageContainer->hdc, NULL, attrib_list);
+
+	if (!testctx)
+	{
+		return EGL_FALSE;
+	}
+
+	wglDeleteContext_PTR(testctx);
+
+	return EGL_TRUE;
+}
+
+EGLBoolean __processAttribList(const EGLDisplayImpl* walkerDpy, EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error)
 {
 	if (!target_attrib_list || !attrib_list || !error)
 	{
@@ -492,7 +459,7 @@ EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EG
 	return EGL_TRUE;
 }
 
-EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error)
+EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error)
 {
 	if (!newSurface || !walkerDpy || !walkerConfig || !error)
 	{
@@ -607,7 +574,7 @@ EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint *attr
 	return EGL_TRUE;
 }
 
-EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error)
+EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error)
 {
 	if (!newSurface || !walkerDpy || !walkerConfig || !error)
 	{
@@ -798,7 +765,7 @@ EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType
 	return EGL_TRUE;
 }
 
-EGLBoolean __destroySurface(EGLNativeDisplayType dpy, const EGLSurfaceImpl* surface)
+EGLBoolean __destroySurface(const EGLSurfaceImpl* surface)
 {
 	if (!surface)
 	{
@@ -1135,9 +1102,9 @@ EGLBoolean __createContext(NativeContextContainer* nativeContextContainer, const
 	return nativeContextContainer->ctx != 0;
 }
 
-EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* nativeContextContainer)
+EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* drawSurfaceContainer, const NativeSurfaceContainer* readSurfaceContainer, const NativeContextContainer* nativeContextContainer)
 {
-	if (!walkerDpy || (nativeContextContainer && !nativeSurfaceContainer))
+	if (!walkerDpy || (nativeContextContainer && !drawSurfaceContainer))
 	{
 		return EGL_FALSE;
 	}
@@ -1145,10 +1112,33 @@ EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceCon
 	if (!nativeContextContainer)
 		return (EGLBoolean)wglMakeCurrent_PTR(NULL, NULL);
 
-	BOOL res = (EGLBoolean)wglMakeCurrent_PTR(nativeSurfaceContainer->hdc, nativeContextContainer->ctx);
+	// WGL_ARB_make_current_read binds a separate read surface. Without it, reads come from the draw surface.
+	if (readSurfaceContainer && readSurfaceContainer->hdc != drawSurfaceContainer->hdc && wglMakeContextCurrentARB)
+	{
+		return (EGLBoolean)wglMakeContextCurrentARB(drawSurfaceContainer->hdc, readSurfaceContainer->hdc, nativeContextContainer->ctx);
+	}
+
+	BOOL res = (EGLBoolean)wglMakeCurrent_PTR(drawSurfaceContainer->hdc, nativeContextContainer->ctx);
 	return res;
 }
 
+EGLBoolean __isCompatibleContext(const NativeContextContainer* nativeContextContainer, const NativeSurfaceContainer* nativeSurfaceContainer, EGLBoolean exactConfig)
+{
+	// The pixel format of a device context follows the configuration, so the configuration ID decides.
+	return EGL_TRUE;
+}
+
+EGLBoolean __surfacelessSurface(NativeSurfaceContainer* nativeSurfaceContainer, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig)
+{
+	// wglMakeCurrent always needs a device context.
+	return EGL_FALSE;
+}
+
+EGLBoolean __hasExtension(const EGLDisplayImpl* walkerDpy, const char* extension)
+{
+	return EGL_FALSE;
+}
+
 EGLBoolean __swapBuffers(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface)
 {
 	if (!walkerDpy || !walkerSurface)
@@ -1159,7 +1149,7 @@ EGLBoolean __swapBuffers(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl*
 	return (EGLBoolean)SwapBuffers(walkerSurface->nativeSurfaceContainer.hdc);
 }
 
-EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, EGLint interval)
+EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface, EGLint interval)
 {
 	if (!walkerDpy)
 	{
@@ -1169,6 +1159,19 @@ EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, EGLint interval)
 	return (EGLBoolean)wglSwapIntervalEXT(interval);
 }
 
+EGLBoolean __waitNative(const EGLDisplayImpl* walkerDpy)
+{
+	if (!walkerDpy)
+	{
+		return EGL_FALSE;
+	}
+
+	// GDI batches its drawing calls.
+	GdiFlush();
+
+	return EGL_TRUE;
+}
+
 EGLBoolean __getPlatformDependentHandles(void* _out, const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* nativeContextContainer)
 {
 	if (!nativeSurfaceContainer || !nativeContextContainer)
@@ -25,10 +25,16 @@
  */
 
 #include "egl_internal.h"
+#include <EGL/eglext.h>
 #include "../../EGL/include/EGL/eglctxinternals.h"
 #include <iostream>
+#include <string>
 #include <thread>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #if defined(EGL_NO_GLEW)
 typedef GLXContext (*__PFN_glXCreateContextAttribsARB)(Display*, GLXFBConfig,
@@ -55,6 +61,9 @@ decltype(XDestroyWindow)* XDestroyWindow_PTR = NULL;
 decltype(XFree)* XFree_PTR = NULL;
 decltype(XGetErrorText)* XGetErrorText_PTR = NULL;
 decltype(XSetErrorHandler)* XSetErrorHandler_PTR = NULL;
+decltype(XSync)* XSync_PTR = NULL;
+decltype(XInitThreads)* XInitThreads_PTR = NULL;
+decltype(XDisplayString)* XDisplayString_PTR = NULL;
 //glX
 decltype(glXGetProcAddress)* glXGetProcAddress_PTR = NULL;
 Bool(*glXQueryVersion_PTR)(Display*,int*,int*) = NULL;
@@ -66,11 +75,17 @@ GLXFBConfig*(*glXChooseFBConfig_PTR)(Display*,int,const int*, int*) = NULL;
 int(*glXGetFBConfigAttrib_PTR)(Display*,GLXFBConfig,int,int*) = NULL;
 XVisualInfo*(*glXGetVisualFromFBConfig_PTR)(Display*,GLXFBConfig) = NULL;
 void(*glXSwapBuffers_PTR)(Display*,GLXDrawable) = NULL;
+void(*glXWaitX_PTR)() = NULL;
 GLXPbuffer(*glXCreatePbuffer_PTR)(Display*,GLXFBConfig,const int*) = NULL;
 void(*glXDestroyPbuffer_PTR)(Display*,GLXPbuffer) = NULL;
 const char*(*glXQueryExtensionsString_PTR)(Display*,int) = NULL;
 GLXFBConfig*(*glXGetFBConfigs_PTR)(Display*,int,int*) = NULL;
 Bool(*glXMakeContextCurrent_PTR)(Display*,GLXDrawable,GLXDrawable,GLXContext) = NULL;
+const char*(*glXQueryServerString_PTR)(Display*,int,int) = NULL;
+const char*(*glXGetClientString_PTR)(Display*,int) = NULL;
+Display*(*glXGetCurrentDisplay_PTR)() = NULL;
+//GL
+const GLubyte*(*glGetString_PTR)(GLenum) = NULL;
 
 __eglMustCastToProperFunctionPointerType __getProcAddress(const char *procname)
 {
@@ -90,7 +105,449 @@ static void logglxcall(const char* fname)
 #	define logglxcall(fname)
 #endif
 
-EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer, EGLint* GL_max_supported, EGLint* ES_max_supported)
+//
+// Threading.
+//
+// Xlib is initialized for concurrent use, unless EGL_X11_INIT_THREADS is "0". If EGL_X11_THREAD_DISPLAY is "1", pbuffers
+// and the contexts bound to them use a separate X connection per thread, so these threads do not contend for the
+// Xlib lock of the shared connection.
+//
+
+static bool g_threadDisplays = false;
+
+// GLX_ARB_context_flush_control and GLX_ARB_create_context_no_error, as not every GLX header declares them.
+
+#ifndef GLX_CONTEXT_RELEASE_BEHAVIOR_ARB
+#define GLX_CONTEXT_RELEASE_BEHAVIOR_ARB 0x2097
+#define GLX_CONTEXT_RELEASE_BEHAVIOR_NONE_ARB 0
+#define GLX_CONTEXT_RELEASE_BEHAVIOR_FLUSH_ARB 0x2098
+#endif
+
+#ifndef GLX_CONTEXT_OPENGL_NO_ERROR_ARB
+#define GLX_CONTEXT_OPENGL_NO_ERROR_ARB 0x31B3
+#endif
+
+static std::mutex g_threadDisplayMutex;
+// All per thread connections. Closed on termination, after all surfaces and contexts are gone.
+static std::vector<Display*> g_threadDisplayList;
+
+static bool __envFlag(const char* name, bool defaultValue)
+{
+	const char* value = getenv(name);
+
+	if (!value || !*value)
+	{
+		return defaultValue;
+	}
+
+	return strcmp(value, "0") != 0;
+}
+
+// Connection of a thread to the server of a display, with its frame buffer configurations by identifier. These are
+// fetched once, when the connection is opened.
+struct ThreadDisplay
+{
+	Display* display;
+
+	std::map<int, GLXFBConfig> fbConfigs;
+};
+
+// Returns the connection of the calling thread to the server of the given display, or 0 for the shared connection.
+static const ThreadDisplay* __threadDisplayEntry(const EGLDisplayImpl* walkerDpy)
+{
+	if (!g_threadDisplays)
+	{
+		return 0;
+	}
+
+	static thread_local std::map<Display*, ThreadDisplay> threadDisplays;
+
+	auto it = threadDisplays.find(walkerDpy->display_id);
+	if (it != threadDisplays.end())
+	{
+		return it->second.display ? &it->second : 0;
+	}
+
+	// A failure is kept as well, so the shared connection is used without trying again.
+	ThreadDisplay& threadDisplay = threadDisplays[walkerDpy->display_id];
+
+	threadDisplay.display = XOpenDisplay_PTR(XDisplayString_PTR(walkerDpy->display_id));
+	if (!threadDisplay.display)
+	{
+		return 0;
+	}
+
+	{
+		std::lock_guard<std::mutex> _{ g_threadDisplayMutex };
+		g_threadDisplayList.push_back(threadDisplay.display);
+	}
+
+	int numberFBConfigs = 0;
+	logglxcall("glXGetFBConfigs");
+	GLXFBConfig* fbConfigs = glXGetFBConfigs_PTR(threadDisplay.display, DefaultScreen(threadDisplay.display), &numberFBConfigs);
+
+	for (int i = 0; fbConfigs && i < numberFBConfigs; i++)
+	{
+		int fbConfigId = 0;
+
+		if (glXGetFBConfigAttrib_PTR(threadDisplay.display, fbConfigs[i], GLX_FBCONFIG_ID, &fbConfigId) == Success)
+		{
+			threadDisplay.fbConfigs[fbConfigId] = fbConfigs[i];
+		}
+	}
+
+	if (fbConfigs)
+	{
+		XFree_PTR(fbConfigs);
+	}
+
+	return &threadDisplay;
+}
+
+static Display* __threadDisplay(const EGLDisplayImpl* walkerDpy)
+{
+	const ThreadDisplay* threadDisplay = __threadDisplayEntry(walkerDpy);
+
+	return threadDisplay ? threadDisplay->display : walkerDpy->display_id;
+}
+
+// Returns the frame buffer configuration of the display with the same identifier on the connection of the calling thread.
+static GLXFBConfig __threadFBConfig(const EGLDisplayImpl* walkerDpy, GLXFBConfig config)
+{
+	const ThreadDisplay* threadDisplay = __threadDisplayEntry(walkerDpy);
+
+	if (!threadDisplay || !config)
+	{
+		return config;
+	}
+
+	// Answered from the configuration itself, without a request to the server.
+	int fbConfigId = 0;
+	if (glXGetFBConfigAttrib_PTR(walkerDpy->display_id, config, GLX_FBCONFIG_ID, &fbConfigId) != Success)
+	{
+		return 0;
+	}
+
+	auto it = threadDisplay->fbConfigs.find(fbConfigId);
+
+	return it != threadDisplay->fbConfigs.end() ? it->second : 0;
+}
+
+// Matches whole names only, as some extension names are prefixes of others.
+static bool __hasGLXExtension(Display* display, const char* extension)
+{
+	logglxcall("glXQueryExtensionsString");
+	const char* extensions = glXQueryExtensionsString_PTR(display, DefaultScreen(display));
+	const size_t length = strlen(extension);
+
+	while (extensions && (extensions = strstr(extensions, extension)) != NULL)
+	{
+		if (extensions[length] == ' ' || extensions[length] == '\0')
+		{
+			return true;
+		}
+
+		extensions += length;
+	}
+
+	return false;
+}
+
+//
+// Persistent configuration cache.
+//
+// If EGL_CONFIG_CACHE names a file, the configurations built by __initialize are stored there and reused by later
+// processes, as long as the driver, the X server and the number of GLX frame buffer configurations did not change.
+//
+
+#define EGL_CONFIG_CACHE_MAGIC "EGLCFGC"
+#define EGL_CONFIG_CACHE_VERSION 4
+
+// Attributes of a configuration stored in the cache, in record order.
+static EGLint EGLConfigImpl::* const g_configCacheAttributes[] = {
+	&EGLConfigImpl::alphaMaskSize,
+	&EGLConfigImpl::alphaSize,
+	&EGLConfigImpl::bindToTextureRGB,
+	&EGLConfigImpl::bindToTextureRGBA,
+	&EGLConfigImpl::blueSize,
+	&EGLConfigImpl::bufferSize,
+	&EGLConfigImpl::colorBufferType,
+	&EGLConfigImpl::configCaveat,
+	&EGLConfigImpl::configId,
+	&EGLConfigImpl::conformant,
+	&EGLConfigImpl::depthSize,
+	&EGLConfigImpl::greenSize,
+	&EGLConfigImpl::level,
+	&EGLConfigImpl::luminanceSize,
+	&EGLConfigImpl::matchNativePixmap,
+	&EGLConfigImpl::maxPBufferHeight,
+	&EGLConfigImpl::maxPBufferPixels,
+	&EGLConfigImpl::maxPBufferWidth,
+	&EGLConfigImpl::maxSwapInterval,
+	&EGLConfigImpl::minSwapInterval,
+	&EGLConfigImpl::nativeRenderable,
+	&EGLConfigImpl::nativeVisualId,
+	&EGLConfigImpl::nativeVisualType,
+	&EGLConfigImpl::redSize,
+	&EGLConfigImpl::renderableType,
+	&EGLConfigImpl::sampleBuffers,
+	&EGLConfigImpl::samples,
+	&EGLConfigImpl::stencilSize,
+	&EGLConfigImpl::surfaceType,
+	&EGLConfigImpl::transparentBlueValue,
+	&EGLConfigImpl::transparentGreenValue,
+	&EGLConfigImpl::transparentRedValue,
+	&EGLConfigImpl::transparentType,
+	&EGLConfigImpl::drawToWindow,
+	&EGLConfigImpl::drawToPixmap,
+	&EGLConfigImpl::drawToPBuffer,
+	&EGLConfigImpl::doubleBuffer,
+};
+
+#define EGL_CONFIG_CACHE_ATTRIBUTES (sizeof(g_configCacheAttributes) / sizeof(g_configCacheAttributes[0]))
+
+// A configuration in the cache file. Only fixed size integers, so the layout does not depend on EGLConfigImpl. The frame
+// buffer configuration is found again by its GLX_FBCONFIG_ID.
+typedef struct _EGLConfigCacheRecord
+{
+	int32_t fbConfigId;
+	int32_t srgbCapable;
+	int32_t attributes[EGL_CONFIG_CACHE_ATTRIBUTES];
+} EGLConfigCacheRecord;
+
+typedef struct _EGLConfigCacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t keySize;
+	uint32_t numberPixelFormats;
+	uint32_t numberConfigs;
+	uint32_t checksum;
+} EGLConfigCacheHeader;
+
+// Vendor, renderer and version of the GL driver, gathered while the dummy context is current.
+static std::string g_driverIdentity;
+
+static size_t __configCacheRecordsOffset(uint32_t keySize)
+{
+	return (sizeof(EGLConfigCacheHeader) + keySize + 7) & ~(size_t)7;
+}
+
+static uint32_t __configCacheChecksum(const std::string& key, const void* records, size_t size)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < key.size(); i++)
+	{
+		hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ ((const uint8_t*)records)[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+static std::string __configCacheKey(Display* display)
+{
+	const int screen = DefaultScreen(display);
+
+	const char* strings[] = {
+		DisplayString(display),
+		ServerVendor(display),
+		glXQueryServerString_PTR ? glXQueryServerString_PTR(display, screen, GLX_VENDOR) : 0,
+		glXQueryServerString_PTR ? glXQueryServerString_PTR(display, screen, GLX_VERSION) : 0,
+		glXGetClientString_PTR ? glXGetClientString_PTR(display, GLX_VENDOR) : 0,
+		glXGetClientString_PTR ? glXGetClientString_PTR(display, GLX_VERSION) : 0
+	};
+
+	std::string key = g_driverIdentity;
+
+	key += '\n';
+	key += std::to_string(VendorRelease(display));
+	key += '\n';
+	key += std::to_string(screen);
+
+	for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++)
+	{
+		key += '\n';
+		if (strings[i])
+		{
+			key += strings[i];
+		}
+	}
+
+	return key;
+}
+
+// Maps the cache file and returns its header, if it is valid for the given key. Release with __unmapConfigCache.
+static const EGLConfigCacheHeader* __mapConfigCache(const std::string& key, EGLint numberPixelFormats, size_t* mappingSize)
+{
+	const char* path = getenv("EGL_CONFIG_CACHE");
+
+	if (!path || !*path || g_driverIdentity.empty())
+	{
+		return 0;
+	}
+
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return 0;
+	}
+
+	struct stat fileStat;
+
+	if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(EGLConfigCacheHeader))
+	{
+		close(fd);
+
+		return 0;
+	}
+
+	void* mapping = mmap(0, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+	{
+		return 0;
+	}
+
+	const EGLConfigCacheHeader* header = (const EGLConfigCacheHeader*)mapping;
+	const size_t recordsOffset = __configCacheRecordsOffset(header->keySize);
+
+	if (memcmp(header->magic, EGL_CONFIG_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != EGL_CONFIG_CACHE_VERSION ||
+		header->recordSize != sizeof(EGLConfigCacheRecord) ||
+		header->keySize != key.size() ||
+		header->numberPixelFormats != (uint32_t)numberPixelFormats ||
+		(size_t)fileStat.st_size != recordsOffset + (size_t)header->numberConfigs * sizeof(EGLConfigCacheRecord) ||
+		memcmp((const char*)mapping + sizeof(EGLConfigCacheHeader), key.data(), key.size()) != 0 ||
+		header->checksum != __configCacheChecksum(key, (const char*)mapping + recordsOffset, (size_t)header->numberConfigs * sizeof(EGLConfigCacheRecord)))
+	{
+		munmap(mapping, (size_t)fileStat.st_size);
+
+		return 0;
+	}
+
+	*mappingSize = (size_t)fileStat.st_size;
+
+	return header;
+}
+
+static void __unmapConfigCache(const EGLConfigCacheHeader* header, size_t mappingSize)
+{
+	munmap((void*)header, mappingSize);
+}
+
+static const EGLConfigCacheRecord* __configCacheRecords(const EGLConfigCacheHeader* header)
+{
+	return (const EGLConfigCacheRecord*)((const char*)header + __configCacheRecordsOffset(header->keySize));
+}
+
+// Restores a configuration from its record. Fails, if the frame buffer configuration is not the one of the record.
+static EGLBoolean __readConfigCacheRecord(EGLConfigImpl* config, const EGLConfigCacheRecord* record, Display* display, const GLXFBConfig* fbConfigs, EGLint numberPixelFormats)
+{
+	_eglInternalSetDefaultConfig(config);
+
+	for (size_t i = 0; i < EGL_CONFIG_CACHE_ATTRIBUTES; i++)
+	{
+		config->*g_configCacheAttributes[i] = (EGLint)record->attributes[i];
+	}
+
+	int fbConfigId = 0;
+
+	if (config->configId < 0 || config->configId >= numberPixelFormats ||
+		glXGetFBConfigAttrib_PTR(display, fbConfigs[config->configId], GLX_FBCONFIG_ID, &fbConfigId) != Success ||
+		fbConfigId != record->fbConfigId)
+	{
+		return EGL_FALSE;
+	}
+
+	config->handle = 0;
+	config->nativeConfigContainer.config = fbConfigs[config->configId];
+	config->nativeConfigContainer.srgbCapable = record->srgbCapable ? True : False;
+	config->nativeConfigContainer.srgbConfig = record->srgbCapable ? fbConfigs[config->configId] : 0;
+	config->next = 0;
+
+	return EGL_TRUE;
+}
+
+static void __writeConfigCache(const std::string& key, EGLint numberPixelFormats, Display* display, const EGLConfigImpl* rootConfig)
+{
+	const char* path = getenv("EGL_CONFIG_CACHE");
+
+	if (!path || !*path || g_driverIdentity.empty())
+	{
+		return;
+	}
+
+	std::vector<EGLConfigCacheRecord> records;
+
+	for (const EGLConfigImpl* walkerConfig = rootConfig; walkerConfig; walkerConfig = walkerConfig->next)
+	{
+		EGLConfigCacheRecord record;
+		memset(&record, 0, sizeof(record));
+
+		int fbConfigId = 0;
+
+		if (glXGetFBConfigAttrib_PTR(display, walkerConfig->nativeConfigContainer.config, GLX_FBCONFIG_ID, &fbConfigId) != Success)
+		{
+			return;
+		}
+
+		record.fbConfigId = fbConfigId;
+		record.srgbCapable = walkerConfig->nativeConfigContainer.srgbCapable ? 1 : 0;
+
+		for (size_t i = 0; i < EGL_CONFIG_CACHE_ATTRIBUTES; i++)
+		{
+			record.attributes[i] = (int32_t)(walkerConfig->*g_configCacheAttributes[i]);
+		}
+
+		records.push_back(record);
+	}
+
+	EGLConfigCacheHeader header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, EGL_CONFIG_CACHE_MAGIC, sizeof(header.magic));
+	header.version = EGL_CONFIG_CACHE_VERSION;
+	header.recordSize = sizeof(EGLConfigCacheRecord);
+	header.keySize = (uint32_t)key.size();
+	header.numberPixelFormats = (uint32_t)numberPixelFormats;
+	header.numberConfigs = (uint32_t)records.size();
+	header.checksum = __configCacheChecksum(key, records.data(), records.size() * sizeof(EGLConfigCacheRecord));
+
+	std::vector<char> padding(__configCacheRecordsOffset(header.keySize) - sizeof(header) - key.size(), 0);
+
+	// Write to a temporary file first, so concurrently starting processes never map a partially written cache.
+	std::string temporaryPath = std::string(path) + "." + std::to_string(getpid());
+
+	FILE* file = fopen(temporaryPath.c_str(), "wb");
+
+	if (!file)
+	{
+		return;
+	}
+
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(key.data(), 1, key.size(), file) == key.size() &&
+		fwrite(padding.data(), 1, padding.size(), file) == padding.size() &&
+		fwrite(records.data(), sizeof(EGLConfigCacheRecord), records.size(), file) == records.size();
+
+	if (fclose(file) != 0 || !written || rename(temporaryPath.c_str(), path) != 0)
+	{
+		unlink(temporaryPath.c_str());
+	}
+}
+
+EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContainer)
 {
 	if (nativeLocalStorageContainer->display && nativeLocalStorageContainer->window && nativeLocalStorageContainer->ctx)
 	{
@@ -121,6 +578,9 @@ EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContain
 	LOAD_X11_FUNC_PTR(XFree);
 	LOAD_X11_FUNC_PTR(XGetErrorText);
 	LOAD_X11_FUNC_PTR(XSetErrorHandler);
+	LOAD_X11_FUNC_PTR(XSync);
+	LOAD_X11_FUNC_PTR(XInitThreads);
+	LOAD_X11_FUNC_PTR(XDisplayString);
 	//LOAD_GLX_FUNC_PTR(glXGetProcAddress);
 	glXGetProcAddress_PTR = (decltype(glXGetProcAddress_PTR)) dlsym(libgl, "glXGetProcAddress");
 	if (!glXGetProcAddress_PTR)
@@ -135,11 +595,24 @@ EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContain
 	LOAD_GLX_FUNC_PTR(glXGetFBConfigAttrib);
 	LOAD_GLX_FUNC_PTR(glXGetVisualFromFBConfig);
 	LOAD_GLX_FUNC_PTR(glXSwapBuffers);
+	LOAD_GLX_FUNC_PTR(glXWaitX);
 	LOAD_GLX_FUNC_PTR(glXCreatePbuffer);
 	LOAD_GLX_FUNC_PTR(glXDestroyPbuffer);
 	LOAD_GLX_FUNC_PTR(glXQueryExtensionsString);
 	LOAD_GLX_FUNC_PTR(glXGetFBConfigs);
 	LOAD_GLX_FUNC_PTR(glXMakeContextCurrent);
+	LOAD_GLX_FUNC_PTR(glXQueryServerString);
+	LOAD_GLX_FUNC_PTR(glXGetClientString);
+	LOAD_GLX_FUNC_PTR(glXGetCurrentDisplay);
+	glGetString_PTR = (decltype(glGetString_PTR)) __getProcAddress("glGetString");
+
+	// Has to be the first Xlib call. Displays opened by the application before are not covered with old Xlib versions.
+	if (__envFlag("EGL_X11_INIT_THREADS", true) && XInitThreads_PTR)
+	{
+		XInitThreads_PTR();
+
+		g_threadDisplays = __envFlag("EGL_X11_THREAD_DISPLAY", false);
+	}
 
 	nativeLocalStorageContainer->display = XOpenDisplay_PTR(NULL);
 
@@ -255,75 +728,27 @@ EGLBoolean __internalInit(NativeLocalStorageContainer* nativeLocalStorageContain
   glFinish_PTR = (__PFN_glFinish)__getProcAddress("glFinish");
 #endif
 
-  int count;
-  GLXFBConfig config = NULL;
+  // Identify the driver, while the dummy context is current.
+  g_driverIdentity.clear();
+  if (glGetString_PTR)
   {
-	  GLXFBConfig* configs = glXGetFBConfigs_PTR(nativeLocalStorageContainer->display, 0, &count);
-	  config = configs[0];
-	  XFree_PTR(configs);
-  }
-
-  EGLint attrib_list[CONTEXT_ATTRIB_LIST_SIZE] = {
-		  GLX_CONTEXT_MAJOR_VERSION_ARB, 1,
-		  GLX_CONTEXT_MINOR_VERSION_ARB, 0,
-		  GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
-		  0
-  };
+	  const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
 
-  GLXContext testctx;
-  EGLint GL_major = 4, GL_minor = 6;
-  for (; GL_major >= 1 && !testctx; --GL_major)
-  {
-	  for (; GL_minor >= 0 && !testctx; --GL_minor)
+	  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
 	  {
-		  attrib_list[1] = GL_major;
-		  attrib_list[3] = GL_minor;
-		  testctx = glXCreateContextAttribsARB_PTR(nativeLocalStorageContainer->display, config, NULL, True, attrib_list);
-	  }
-  }
-  ++GL_major;
-  ++GL_minor;
+		  const char* value = (const char*)glGetString_PTR(names[i]);
 
-  if (testctx)
-  {
-	  glXDestroyContext_PTR(nativeLocalStorageContainer->display, testctx);
-	  testctx = NULL;
-  }
-  else
-  {
-	  GL_major = 0;
-	  GL_minor = 0;
-  }
-  GL_max_supported[0] = GL_major;
-  GL_max_supported[1] = GL_minor;
+		  if (!value)
+		  {
+			  g_driverIdentity.clear();
 
+			  break;
+		  }
 
-  attrib_list[5] = GLX_CONTEXT_ES_PROFILE_BIT_EXT;
-  EGLint ES_major = 3, ES_minor = 2;
-  for (; ES_major >= 1 && !testctx; --ES_major)
-  {
-	  for (; ES_minor >= 0 && !testctx; --ES_minor)
-	  {
-		  attrib_list[1] = ES_major;
-		  attrib_list[3] = ES_minor;
-		  testctx = glXCreateContextAttribsARB_PTR(nativeLocalStorageContainer->display, config, NULL, True, attrib_list);
+		  g_driverIdentity += value;
+		  g_driverIdentity += '\n';
 	  }
   }
-  ++ES_major;
-  ++ES_minor;
-
-  if (testctx)
-  {
-	  glXDestroyContext_PTR(nativeLocalStorageContainer->display, testctx);
-	  testctx = NULL;
-  }
-  else
-  {
-	  ES_major = 0;
-	  ES_minor = 0;
-  }
-  ES_max_supported[0] = ES_major;
-  ES_max_supported[1] = ES_minor;
 
   return EGL_TRUE;
 }
@@ -360,6 +785,16 @@ EGLBoolean __internalTerminate(NativeLocalStorageContainer* nativeLocalStorageCo
 		nativeLocalStorageContainer->display = 0;
 	}
 
+	{
+		std::lock_guard<std::mutex> _{ g_threadDisplayMutex };
+
+		for (Display* threadDisplay : g_threadDisplayList)
+		{
+			XCloseDisplay_PTR(threadDisplay);
+		}
+		g_threadDisplayList.clear();
+	}
+
 	dlclose(libx11);
 	dlclose(libgl);
 
@@ -374,14 +809,58 @@ EGLBoolean __deleteContext(const EGLDisplayImpl* walkerDpy, const NativeContextC
 	}
 
 	logglxcall("glXDestroyContext");
-	glXDestroyContext_PTR(walkerDpy->display_id, nativeContextContainer->ctx);
+	glXDestroyContext_PTR(nativeContextContainer->display, nativeContextContainer->ctx);
+
+	return EGL_TRUE;
+}
+
+// The X error handler is process global, so swapping it has to be serialized across all displays and threads.
+static std::mutex g_errorHandlerMutex;
+
+static int __ignoreXError(Display*, XErrorEvent*)
+{
+	return 0;
+}
+
+EGLBoolean __probeContextVersion(const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, const NativeLocalStorageContainer*, const EGLint* attribList, EGLint major, EGLint minor)
+{
+	if (!walkerDpy || !walkerConfig || !walkerConfig->nativeConfigContainer.config || !attribList || !glXCreateContextAttribsARB_PTR)
+	{
+		return EGL_FALSE;
+	}
+
+	// The attributes of the context, with the version in front as laid out by __processAttribList.
+	EGLint probeAttribList[CONTEXT_ATTRIB_LIST_SIZE];
+	memcpy(probeAttribList, attribList, sizeof(probeAttribList));
+	probeAttribList[1] = major;
+	probeAttribList[3] = minor;
+
+	// An unsupported version raises an X error, which would terminate the process with the default handler.
+	std::lock_guard<std::mutex> _{ g_errorHandlerMutex };
+
+	XSync_PTR(walkerDpy->display_id, False);
+	auto previousHandler = XSetErrorHandler_PTR(__ignoreXError);
+
+	logglxcall("glXCreateContextAttribsARB");
+	GLXContext testCtx = glXCreateContextAttribsARB_PTR(walkerDpy->display_id, walkerConfig->nativeConfigContainer.config, 0, True, probeAttribList);
+
+	XSync_PTR(walkerDpy->display_id, False);
+	XSetErrorHandler_PTR(previousHandler);
+
+	if (!testCtx)
+	{
+		return EGL_FALSE;
+	}
+
+	logglxcall("glXDestroyContext");
+	glXDestroyContext_PTR(walkerDpy->display_id, testCtx);
 
 	return EGL_TRUE;
 }
 
-EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error)
+EGLBoolean __processAttribList(const EGLDisplayImpl* walkerDpy, EGLenum api, EGLint* target_attrib_list, const EGLint* attrib_list, EGLint* error)
 {
-	if (!target_attrib_list || !attrib_list || !error)
+	if (!walkerDpy || !target_attrib_list || !attrib_list || !error)
 	{
 		return EGL_FALSE;
 	}
@@ -397,6 +876,10 @@ EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EG
 	};
 	template_attrib_list[CONTEXT_ATTRIB_LIST_SIZE-1] = 0;
 
+	// Attributes of extensions, which might be missing, are only appended when they differ from the default.
+	EGLint optionalIndex = 10;
+	bool noError = false;
+
 	EGLint attribListIndex = 0;
 
 	while (attrib_list[attribListIndex] != EGL_NONE)
@@ -519,6 +1002,43 @@ EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EG
 				}
 			}
 			break;
+			case EGL_CONTEXT_RELEASE_BEHAVIOR_KHR:
+			{
+				if (!walkerDpy->contextFlushControl || (value != EGL_CONTEXT_RELEASE_BEHAVIOR_NONE_KHR && value != EGL_CONTEXT_RELEASE_BEHAVIOR_FLUSH_KHR))
+				{
+					*error = EGL_BAD_ATTRIBUTE;
+
+					return EGL_FALSE;
+				}
+
+				// Flushing on release is the default.
+				if (value == EGL_CONTEXT_RELEASE_BEHAVIOR_NONE_KHR)
+				{
+					template_attrib_list[optionalIndex++] = GLX_CONTEXT_RELEASE_BEHAVIOR_ARB;
+					template_attrib_list[optionalIndex++] = GLX_CONTEXT_RELEASE_BEHAVIOR_NONE_ARB;
+					template_attrib_list[optionalIndex] = 0;
+				}
+			}
+			break;
+			case EGL_CONTEXT_OPENGL_NO_ERROR_KHR:
+			{
+				if (!walkerDpy->contextNoError || (value != EGL_TRUE && value != EGL_FALSE))
+				{
+					*error = EGL_BAD_ATTRIBUTE;
+
+					return EGL_FALSE;
+				}
+
+				if (value == EGL_TRUE)
+				{
+					template_attrib_list[optionalIndex++] = GLX_CONTEXT_OPENGL_NO_ERROR_ARB;
+					template_attrib_list[optionalIndex++] = True;
+					template_attrib_list[optionalIndex] = 0;
+
+					noError = true;
+				}
+			}
+			break;
 			default:
 			{
 				*error = EGL_BAD_ATTRIBUTE;
@@ -530,8 +1050,8 @@ EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EG
 
 		attribListIndex += 2;
 
-		// More than 14 entries can not exist.
-		if (attribListIndex >= 7 * 2)
+		// More than 18 entries can not exist.
+		if (attribListIndex >= 9 * 2)
 		{
 			*error = EGL_BAD_ATTRIBUTE;
 
@@ -539,12 +1059,69 @@ EGLBoolean __processAttribList(EGLenum api, EGLint* target_attrib_list, const EG
 		}
 	}
 
+	// A context without errors can not report them or guarantee robust access.
+	if (noError && (template_attrib_list[5] & (GLX_CONTEXT_DEBUG_BIT_ARB | GLX_CONTEXT_ROBUST_ACCESS_BIT_ARB)))
+	{
+		*error = EGL_BAD_MATCH;
+
+		return EGL_FALSE;
+	}
+
 	memcpy(target_attrib_list, template_attrib_list, CONTEXT_ATTRIB_LIST_SIZE * sizeof(EGLint));
 
 	return EGL_TRUE;
 }
 
-EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error)
+// Returns the frame buffer configuration for a surface. The sRGB capable variant is searched once per configuration.
+// Surfaces are created under the display lock, which also guards the resolved configuration.
+static GLXFBConfig __resolveFBConfig(const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLBoolean colorspace_srgb)
+{
+	NativeConfigContainer* nativeConfigContainer = &walkerConfig->nativeConfigContainer;
+
+	if (!colorspace_srgb)
+	{
+		return nativeConfigContainer->config;
+	}
+
+	if (!nativeConfigContainer->srgbConfig)
+	{
+		int glxchooseAttribs[] = {
+			GLX_BUFFER_SIZE, walkerConfig->bufferSize,
+			GLX_LEVEL, walkerConfig->level,
+			GLX_DOUBLEBUFFER, walkerConfig->doubleBuffer,
+			GLX_RED_SIZE, walkerConfig->redSize,
+			GLX_GREEN_SIZE, walkerConfig->greenSize,
+			GLX_BLUE_SIZE, walkerConfig->blueSize,
+			GLX_ALPHA_SIZE, walkerConfig->alphaSize,
+			GLX_DEPTH_SIZE, walkerConfig->depthSize,
+			GLX_STENCIL_SIZE, walkerConfig->stencilSize,
+			GLX_RENDER_TYPE, GLX_RGBA_BIT,
+			GLX_DRAWABLE_TYPE, (walkerConfig->drawToWindow ?  GLX_WINDOW_BIT : 0) | (walkerConfig->drawToPBuffer ? GLX_PBUFFER_BIT : 0) | (walkerConfig->drawToPixmap ?  GLX_PIXMAP_BIT : 0),
+			GLX_FRAMEBUFFER_SRGB_CAPABLE_ARB, True,
+			GLX_X_RENDERABLE, True,
+			None
+		};
+
+		EGLint numConfigs = 0;
+		logglxcall("glXChooseFBConfig");
+		GLXFBConfig* chooseRetval = glXChooseFBConfig_PTR(walkerDpy->display_id, DefaultScreen(walkerDpy->display_id), glxchooseAttribs, &numConfigs);
+		if (chooseRetval == NULL || numConfigs == 0)
+		{
+			if (chooseRetval)
+			{
+				XFree_PTR(chooseRetval);
+			}
+
+			return 0;
+		}
+		nativeConfigContainer->srgbConfig = chooseRetval[0];
+		XFree_PTR(chooseRetval);
+	}
+
+	return nativeConfigContainer->srgbConfig;
+}
+
+EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error)
 {
 	if (!newSurface || !walkerDpy || !walkerConfig || !error)
 	{
@@ -555,7 +1132,8 @@ EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attr
 		return EGL_FALSE;
 	}
 
-	EGLNativeDisplayType display = walkerDpy->display_id;
+	// Pbuffers are not shared with the window system, so they may live on the connection of the creating thread.
+	Display* display = __threadDisplay(walkerDpy);
 
 	int glxattribs[] =
 	{
@@ -568,7 +1146,7 @@ EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attr
 	int* width = glxattribs + 1;
 	int* height = glxattribs + 3;
 	int* largest_pbuffer = glxattribs + 5;
-	EGLBoolean colorspace_srgb = 1;
+	EGLBoolean colorspace_srgb = 0;
 
 	EGLint currAttrib = 0;
 	while (attrib_list[currAttrib] != EGL_NONE)
@@ -591,31 +1169,13 @@ EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attr
 		currAttrib += 2;
 	}
 
-	GLXFBConfig config = 0;
-	int glxchooseAttribs[] = {
-		GLX_BUFFER_SIZE, walkerConfig->bufferSize,
-		GLX_LEVEL, walkerConfig->level,
-		GLX_DOUBLEBUFFER, walkerConfig->doubleBuffer,
-		GLX_RED_SIZE, walkerConfig->redSize,
-		GLX_GREEN_SIZE, walkerConfig->greenSize,
-		GLX_BLUE_SIZE, walkerConfig->blueSize,
-		GLX_ALPHA_SIZE, walkerConfig->alphaSize,
-		GLX_DEPTH_SIZE, walkerConfig->depthSize,
-		GLX_STENCIL_SIZE, walkerConfig->stencilSize,
-		GLX_RENDER_TYPE, GLX_RGBA_BIT,
-		//GLX_DRAWABLE_TYPE, (walkerConfig->drawToWindow ?  GLX_WINDOW_BIT : 0) | (walkerConfig->drawToPBuffer ? GLX_PBUFFER_BIT : 0) | (walkerConfig->drawToPixmap ?  GLX_PIXMAP_BIT : 0),
-		GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT,
-		GLX_FRAMEBUFFER_SRGB_CAPABLE_ARB, colorspace_srgb,
-		GLX_X_RENDERABLE, True,
-		None
-	};
+	GLXFBConfig config = __threadFBConfig(walkerDpy, __resolveFBConfig(walkerDpy, walkerConfig, colorspace_srgb));
+	if (!config)
+	{
+		*error = EGL_BAD_MATCH;
 
-	EGLint numConfigs = 0;
-	GLXFBConfig* chooseRetval = glXChooseFBConfig_PTR(walkerDpy->display_id, DefaultScreen(walkerDpy->display_id), glxchooseAttribs, &numConfigs);
-	if (chooseRetval==NULL || numConfigs==0)
 		return EGL_FALSE;
-	config = chooseRetval[0];
-	XFree_PTR(chooseRetval);
+	}
 
 	newSurface->drawToWindow = EGL_FALSE;
 	newSurface->drawToPixmap = EGL_FALSE;
@@ -627,13 +1187,14 @@ EGLBoolean __createPbufferSurface(EGLSurfaceImpl* newSurface, const EGLint* attr
 	newSurface->destroy = EGL_FALSE;
 	logglxcall("glXCreatePbuffer");
 	newSurface->pbuf = glXCreatePbuffer_PTR(display, config, glxattribs);
+	newSurface->nativeSurfaceContainer.display = display;
 	newSurface->nativeSurfaceContainer.config = config;
 	newSurface->nativeSurfaceContainer.drawable = newSurface->pbuf;
 
 	return EGL_TRUE;
 }
 
-EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig, EGLint* error)
+EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType win, const EGLint *attrib_list, const EGLDisplayImpl* walkerDpy, EGLConfigImpl* walkerConfig, EGLint* error)
 {
 	if (!newSurface || !walkerDpy || !walkerConfig || !error)
 	{
@@ -641,7 +1202,6 @@ EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType
 	}
 
 	EGLBoolean colorspace_srgb = 0;
-	EGLBoolean doublebuffer = 0;
 	if (attrib_list)
 	{
 		EGLint indexAttribList = 0;
@@ -674,7 +1234,6 @@ EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType
 				{
 					if (value == EGL_SINGLE_BUFFER)
 					{
-						doublebuffer = 0;
 						if (walkerConfig->doubleBuffer)
 						{
 							*error = EGL_BAD_MATCH;
@@ -684,7 +1243,6 @@ EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType
 					}
 					else if (value == EGL_BACK_BUFFER)
 					{
-						doublebuffer = 1;
 						if (!walkerConfig->doubleBuffer)
 						{
 							*error = EGL_BAD_MATCH;
@@ -730,31 +1288,13 @@ EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType
 
 	//
 
-	GLXFBConfig config = 0;
-	int glxchooseAttribs[] = {
-		GLX_BUFFER_SIZE, walkerConfig->bufferSize,
-		GLX_LEVEL, walkerConfig->level,
-		GLX_DOUBLEBUFFER, doublebuffer,
-		GLX_RED_SIZE, walkerConfig->redSize,
-		GLX_GREEN_SIZE, walkerConfig->greenSize,
-		GLX_BLUE_SIZE, walkerConfig->blueSize,
-		GLX_ALPHA_SIZE, walkerConfig->alphaSize,
-		GLX_DEPTH_SIZE, walkerConfig->depthSize,
-		GLX_STENCIL_SIZE, walkerConfig->stencilSize,
-		GLX_RENDER_TYPE, GLX_RGBA_BIT,
-		//GLX_DRAWABLE_TYPE, (walkerConfig->drawToWindow ?  GLX_WINDOW_BIT : 0) | (walkerConfig->drawToPBuffer ? GLX_PBUFFER_BIT : 0) | (walkerConfig->drawToPixmap ?  GLX_PIXMAP_BIT : 0),
-		GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT,
-		GLX_FRAMEBUFFER_SRGB_CAPABLE_ARB, colorspace_srgb,
-		GLX_X_RENDERABLE, True,
-		None
-	};
+	GLXFBConfig config = __resolveFBConfig(walkerDpy, walkerConfig, colorspace_srgb);
+	if (!config)
+	{
+		*error = EGL_BAD_MATCH;
 
-	EGLint numConfigs = 0;
-	GLXFBConfig* chooseRetval = glXChooseFBConfig_PTR(walkerDpy->display_id, DefaultScreen(walkerDpy->display_id), glxchooseAttribs, &numConfigs);
-	if (chooseRetval==NULL || numConfigs==0)
 		return EGL_FALSE;
-	config = chooseRetval[0];
-	XFree_PTR(chooseRetval);
+	}
 
 	newSurface->drawToWindow = EGL_TRUE;
 	newSurface->drawToPixmap = EGL_FALSE;
@@ -765,13 +1305,14 @@ EGLBoolean __createWindowSurface(EGLSurfaceImpl* newSurface, EGLNativeWindowType
 	newSurface->initialized = EGL_TRUE;
 	newSurface->destroy = EGL_FALSE;
 	newSurface->win = win;
+	newSurface->nativeSurfaceContainer.display = walkerDpy->display_id;
 	newSurface->nativeSurfaceContainer.config = config;
 	newSurface->nativeSurfaceContainer.drawable = win;
 
 	return EGL_TRUE;
 }
 
-EGLBoolean __destroySurface(EGLNativeDisplayType dpy, const EGLSurfaceImpl* surface)
+EGLBoolean __destroySurface(const EGLSurfaceImpl* surface)
 {
 	if (!surface)
 	{
@@ -781,7 +1322,7 @@ EGLBoolean __destroySurface(EGLNativeDisplayType dpy, const EGLSurfaceImpl* surf
 	if (surface->drawToPBuffer)
 	{
 		logglxcall("glXDestroyPbuffer");
-		glXDestroyPbuffer_PTR(dpy, surface->pbuf);
+		glXDestroyPbuffer_PTR(surface->nativeSurfaceContainer.display, surface->pbuf);
 	}
 	// else Nothing to release.
 
@@ -795,11 +1336,6 @@ EGLBoolean __initialize(EGLDisplayImpl* walkerDpy, const NativeLocalStorageConta
 		return EGL_FALSE;
 	}
 
-	logglxcall("glXQueryExtensionsString");
-	const char* extensions_str = glXQueryExtensionsString_PTR(walkerDpy->display_id, DefaultScreen(walkerDpy->display_id));
-	int ES_supported = strstr(extensions_str, "GLX_EXT_create_context_es_profile") != NULL;
-	const EGLint ES_mask = ES_supported * (EGL_OPENGL_ES_BIT | EGL_OPENGL_ES2_BIT | EGL_OPENGL_ES3_BIT);
-
 	// Create configuration list.
 
 	EGLint numberPixelFormats;
@@ -819,6 +1355,77 @@ EGLBoolean __initialize(EGLDisplayImpl* walkerDpy, const NativeLocalStorageConta
 		return EGL_FALSE;
 	}
 
+	const std::string cacheKey = __configCacheKey(walkerDpy->display_id);
+
+	{
+		size_t mappingSize;
+		const EGLConfigCacheHeader* header = __mapConfigCache(cacheKey, numberPixelFormats, &mappingSize);
+
+		if (header)
+		{
+			const EGLConfigCacheRecord* records = __configCacheRecords(header);
+
+			EGLBoolean valid = EGL_TRUE;
+
+			EGLConfigImpl* lastConfig = 0;
+			for (uint32_t currentRecord = 0; currentRecord < header->numberConfigs; currentRecord++)
+			{
+				EGLConfigImpl* newConfig = (EGLConfigImpl*)malloc(sizeof(EGLConfigImpl));
+				if (!newConfig)
+				{
+					__unmapConfigCache(header, mappingSize);
+
+					XFree_PTR(fbConfigs);
+
+					*error = EGL_NOT_INITIALIZED;
+
+					return EGL_FALSE;
+				}
+				if (!__readConfigCacheRecord(newConfig, &records[currentRecord], walkerDpy->display_id, fbConfigs, numberPixelFormats))
+				{
+					free(newConfig);
+
+					valid = EGL_FALSE;
+
+					break;
+				}
+				if (lastConfig != 0)
+				{
+					lastConfig->next = newConfig;
+				}
+				else
+				{
+					walkerDpy->rootConfig = newConfig;
+				}
+				lastConfig = newConfig;
+			}
+
+			__unmapConfigCache(header, mappingSize);
+
+			if (valid)
+			{
+				XFree_PTR(fbConfigs);
+
+				return EGL_TRUE;
+			}
+
+			// The frame buffer configurations changed, so the configurations are built again.
+			while (walkerDpy->rootConfig)
+			{
+				EGLConfigImpl* deleteConfig = walkerDpy->rootConfig;
+
+				walkerDpy->rootConfig = walkerDpy->rootConfig->next;
+
+				free(deleteConfig);
+			}
+		}
+	}
+
+	logglxcall("glXQueryExtensionsString");
+	const char* extensions_str = glXQueryExtensionsString_PTR(walkerDpy->display_id, DefaultScreen(walkerDpy->display_id));
+	int ES_supported = strstr(extensions_str, "GLX_EXT_create_context_es_profile") != NULL;
+	const EGLint ES_mask = ES_supported * (EGL_OPENGL_ES_BIT | EGL_OPENGL_ES2_BIT | EGL_OPENGL_ES3_BIT);
+
 	EGLint attribute;
 
 	XVisualInfo* visualInfo;
@@ -948,6 +1555,21 @@ EGLBoolean __initialize(EGLDisplayImpl* walkerDpy, const NativeLocalStorageConta
 		newConfig->colorBufferType = EGL_RGB_BUFFER;
 		newConfig->configId = currentPixelFormat;
 
+		newConfig->nativeConfigContainer.config = fbConfigs[currentPixelFormat];
+
+		attribute = GLX_FRAMEBUFFER_SRGB_CAPABLE_ARB;
+		logglxcall("glXGetFBConfigAttrib");
+		if (glXGetFBConfigAttrib_PTR(walkerDpy->display_id, fbConfigs[currentPixelFormat], attribute, &value) || !value)
+		{
+			newConfig->nativeConfigContainer.srgbCapable = False;
+			newConfig->nativeConfigContainer.srgbConfig = 0;
+		}
+		else
+		{
+			newConfig->nativeConfigContainer.srgbCapable = True;
+			newConfig->nativeConfigContainer.srgbConfig = fbConfigs[currentPixelFormat];
+		}
+
 		attribute = GLX_BUFFER_SIZE;
 		logglxcall("glXGetFBConfigAttrib");
 		if (glXGetFBConfigAttrib_PTR(walkerDpy->display_id, fbConfigs[currentPixelFormat], attribute, &newConfig->bufferSize))
@@ -1183,6 +1805,8 @@ EGLBoolean __initialize(EGLDisplayImpl* walkerDpy, const NativeLocalStorageConta
 
 	XFree_PTR(fbConfigs);
 
+	__writeConfigCache(cacheKey, numberPixelFormats, walkerDpy->display_id, walkerDpy->rootConfig);
+
 	return EGL_TRUE;
 }
 
@@ -1204,26 +1828,108 @@ EGLBoolean __createContext(NativeContextContainer* nativeContextContainer, const
 	}
 	//XSetErrorHandler(xerrorhandler);
 	logglxcall("glXCreateContextAttribsARB");
-	nativeContextContainer->ctx = glXCreateContextAttribsARB_PTR(walkerDpy->display_id, nativeSurfaceContainer->config, sharedNativeContextContainer ? sharedNativeContextContainer->ctx : 0, True, attribList);
+	nativeContextContainer->display = nativeSurfaceContainer->display;
+	nativeContextContainer->config = nativeSurfaceContainer->config;
+	nativeContextContainer->ctx = glXCreateContextAttribsARB_PTR(nativeContextContainer->display, nativeSurfaceContainer->config, sharedNativeContextContainer ? sharedNativeContextContainer->ctx : 0, True, attribList);
 
 	return nativeContextContainer->ctx != 0;
 }
 
-EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* nativeSurfaceContainer, const NativeContextContainer* nativeContextContainer)
+EGLBoolean __makeCurrent(const EGLDisplayImpl* walkerDpy, const NativeSurfaceContainer* drawSurfaceContainer, const NativeSurfaceContainer* readSurfaceContainer, const NativeContextContainer* nativeContextContainer)
 {
-	if (!walkerDpy || (!nativeSurfaceContainer && nativeContextContainer) || (nativeSurfaceContainer && !nativeContextContainer))
+	if (!walkerDpy || (!drawSurfaceContainer && nativeContextContainer) || (drawSurfaceContainer && !nativeContextContainer))
 	{
 		return EGL_FALSE;
 	}
 
+	// The current context may be on another connection of the thread, which has to release it.
+	Display* currentDisplay = glXGetCurrentDisplay_PTR ? glXGetCurrentDisplay_PTR() : NULL;
+
 	if (!nativeContextContainer)
 	{
 		logglxcall("glXMakeCurrent");
-		return (EGLBoolean)glXMakeCurrent_PTR(walkerDpy->display_id, None, NULL);
+		return (EGLBoolean)glXMakeCurrent_PTR(currentDisplay ? currentDisplay : walkerDpy->display_id, None, NULL);
+	}
+
+	if (currentDisplay && currentDisplay != nativeContextContainer->display)
+	{
+		logglxcall("glXMakeCurrent");
+		glXMakeCurrent_PTR(currentDisplay, None, NULL);
+	}
+
+	const GLXDrawable readDrawable = readSurfaceContainer ? readSurfaceContainer->drawable : drawSurfaceContainer->drawable;
+
+	// A separate read drawable, or none at all for surfaceless contexts, which glXMakeCurrent does not accept.
+	if (drawSurfaceContainer->drawable == None || readDrawable != drawSurfaceContainer->drawable)
+	{
+		if (!glXMakeContextCurrent_PTR)
+		{
+			return EGL_FALSE;
+		}
+
+		logglxcall("glXMakeContextCurrent");
+		return (EGLBoolean)glXMakeContextCurrent_PTR(nativeContextContainer->display, drawSurfaceContainer->drawable, readDrawable, nativeContextContainer->ctx);
 	}
 
 	logglxcall("glXMakeCurrent");
-	return (EGLBoolean)glXMakeCurrent_PTR(walkerDpy->display_id, nativeSurfaceContainer->drawable, nativeContextContainer->ctx);
+	return (EGLBoolean)glXMakeCurrent_PTR(nativeContextContainer->display, drawSurfaceContainer->drawable, nativeContextContainer->ctx);
+}
+
+EGLBoolean __isCompatibleContext(const NativeContextContainer* nativeContextContainer, const NativeSurfaceContainer* nativeSurfaceContainer, EGLBoolean exactConfig)
+{
+	if (!nativeContextContainer || !nativeSurfaceContainer)
+	{
+		return EGL_FALSE;
+	}
+
+	// With per thread connections, a context is only bound to drawables of the connection it was created on.
+	if (nativeContextContainer->display != nativeSurfaceContainer->display)
+	{
+		return EGL_FALSE;
+	}
+
+	// Surfaces of one configuration can still differ in the frame buffer configuration, e.g. the sRGB capable one.
+	return !exactConfig || nativeContextContainer->config == nativeSurfaceContainer->config;
+}
+
+EGLBoolean __surfacelessSurface(NativeSurfaceContainer* nativeSurfaceContainer, const EGLDisplayImpl* walkerDpy, const EGLConfigImpl* walkerConfig)
+{
+	if (!nativeSurfaceContainer || !walkerDpy || !walkerConfig || !glXMakeContextCurrent_PTR)
+	{
+		return EGL_FALSE;
+	}
+
+	nativeSurfaceContainer->display = __threadDisplay(walkerDpy);
+	nativeSurfaceContainer->drawable = None;
+	nativeSurfaceContainer->config = __threadFBConfig(walkerDpy, walkerConfig->nativeConfigContainer.config);
+
+	return nativeSurfaceContainer->config != 0;
+}
+
+EGLBoolean __hasExtension(const EGLDisplayImpl* walkerDpy, const char* extension)
+{
+	if (!walkerDpy || !extension)
+	{
+		return EGL_FALSE;
+	}
+
+	// GLX_ARB_create_context allows a context of OpenGL 3.0 and later to be current without drawables.
+	if (strcmp(extension, "EGL_KHR_surfaceless_context") == 0)
+	{
+		return glXCreateContextAttribsARB_PTR && glXMakeContextCurrent_PTR && __hasGLXExtension(walkerDpy->display_id, "GLX_ARB_create_context");
+	}
+
+	if (strcmp(extension, "EGL_KHR_context_flush_control") == 0)
+	{
+		return __hasGLXExtension(walkerDpy->display_id, "GLX_ARB_context_flush_control");
+	}
+
+	if (strcmp(extension, "EGL_KHR_create_context_no_error") == 0)
+	{
+		return __hasGLXExtension(walkerDpy->display_id, "GLX_ARB_create_context_no_error");
+	}
+
+	return EGL_FALSE;
 }
 
 EGLBoolean __swapBuffers(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface)
@@ -1239,15 +1945,36 @@ EGLBoolean __swapBuffers(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl*
 	return EGL_TRUE;
 }
 
-EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, EGLint interval)
+EGLBoolean __swapInterval(const EGLDisplayImpl* walkerDpy, const EGLSurfaceImpl* walkerSurface, EGLint interval)
 {
-	if (!walkerDpy)
+	if (!walkerDpy || !walkerSurface)
 	{
 		return EGL_FALSE;
 	}
 
 	logglxcall("glXSwapIntervalEXT");
-	glXSwapIntervalEXT_PTR(walkerDpy->display_id, walkerDpy->currentDraw->win, interval);
+	glXSwapIntervalEXT_PTR(walkerDpy->display_id, walkerSurface->win, interval);
+
+	return EGL_TRUE;
+}
+
+EGLBoolean __waitNative(const EGLDisplayImpl* walkerDpy)
+{
+	if (!walkerDpy)
+	{
+		return EGL_FALSE;
+	}
+
+	// Completes pending X rendering to the current drawable without draining the GL pipeline.
+	if (glXWaitX_PTR)
+	{
+		logglxcall("glXWaitX");
+		glXWaitX_PTR();
+	}
+	else
+	{
+		XSync_PTR(walkerDpy->display_id, False);
+	}
 
 	return EGL_TRUE;
 }